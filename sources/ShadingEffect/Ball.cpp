@@ -1,68 +1,223 @@
 #include <Gamebuino-Meta.h>
 #include "Ball.h"
+#include "Renderer.h"
+#include "ScreenPalette.h"
 #include "constants.h"
 
-// we copy the descriptive parameters of our sprite
-const uint8_t Ball::FRAME_WIDTH = 16;
-const uint8_t Ball::FRAME_HEIGHT = 16;
-const uint16_t Ball::TRANSPARENT_COLOR = 0xffff;
+// the descriptive parameters of our sprite are referenced by the cache
+constexpr uint8_t Ball::FRAME_WIDTH;
+constexpr uint8_t Ball::FRAME_HEIGHT;
+
 // the ball is positioned in the center of the screen...
 // note that these coordinates correspond to the corner
 // at the top left of our sprite
-const uint8_t Ball::X_POS = (SCREEN_WIDTH - FRAME_WIDTH) / 2;
-const uint8_t Ball::Y_POS = (SCREEN_HEIGHT - FRAME_HEIGHT) / 2;
-
-// we copy the value of the variable `spritedata`
-// that the transcoding tool provided us with
-const uint16_t Ball::BITMAP[] = {
-    0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
-    0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
-    0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff,
-    0xffff, 0xffff, 0xffff, 0xffff, 0x0ef8, 0x5cfe, 0x5cfe, 0x5cfe, 0x5cfe, 0x5cfe, 0x0ef8, 0x0ef8, 0xffff, 0xffff, 0xffff, 0xffff,
-    0xffff, 0xffff, 0xffff, 0x0ef8, 0x5cfe, 0x5cfe, 0x5cfe, 0x5cfe, 0x5cfe, 0x5cfe, 0x5cfe, 0x0ef8, 0x0ef8, 0xffff, 0xffff, 0xffff,
-    0xffff, 0xffff, 0x0ef8, 0x5cfe, 0x5cfe, 0x5cfe, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x5cfe, 0x0ef8, 0x0780, 0xffff, 0xffff,
-    0xffff, 0xffff, 0x0ef8, 0x5cfe, 0x5cfe, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0450, 0x0000, 0xffff,
-    0xffff, 0xffff, 0x0ef8, 0x5cfe, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0780, 0x0450, 0x0000, 0xffff,
-    0xffff, 0xffff, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0780, 0x0450, 0x0000, 0xffff,
-    0xffff, 0xffff, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0780, 0x0780, 0x0450, 0x0000, 0xffff,
-    0xffff, 0xffff, 0x0780, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0780, 0x0450, 0x0450, 0x0000, 0xffff,
-    0xffff, 0xffff, 0xffff, 0x0780, 0x0780, 0x0ef8, 0x0ef8, 0x0ef8, 0x0ef8, 0x0780, 0x0780, 0x0450, 0x0450, 0x0000, 0x0000, 0xffff,
-    0xffff, 0xffff, 0xffff, 0xffff, 0x0450, 0x0780, 0x0780, 0x0780, 0x0780, 0x0780, 0x0450, 0x0450, 0x0000, 0x0000, 0xffff, 0xffff,
-    0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0450, 0x0450, 0x0450, 0x0450, 0x0450, 0x0450, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff,
-    0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xffff, 0xffff, 0xffff, 0xffff,
-    0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff, 0xffff
+const screen_x_t Ball::X_POS = (SCREEN_WIDTH - FRAME_WIDTH) / 2;
+const screen_y_t Ball::Y_POS = (SCREEN_HEIGHT - FRAME_HEIGHT) / 2;
+
+// the frames of the rolling ball (see `assets/ball-rolling-rgb565.txt`),
+// whose colors are those of the ball in the screen palette:
+//   sprite2rle Ball 16 16 16 0xffff 0x0ef8 0x5cfe 0x0780 0x0450 0x0000 < assets/ball-rolling-rgb565.txt
+// the frame of the step (i,j) along the X and Y axes is the frame `j * BALL_ROLL_PHASES + i`
+// 1359 bytes of runs for 16 frames of 256 pixels
+const uint8_t Ball::FRAME_RUNS[] = {
+    0x0f, 0x0f, 0x04, 0x25, 0x04, 0x03, 0x20, 0x44, 0x21, 0x03, 0x02, 0x20, 0x40, 0x20, 0x44, 0x60,
+    0x20, 0x02, 0x01, 0x20, 0x40, 0x27, 0x61, 0x01, 0x01, 0x20, 0x41, 0x27, 0x80, 0xa0, 0x00, 0x01,
+    0x20, 0x40, 0x27, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x29, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x28, 0x61,
+    0x80, 0xa0, 0x00, 0x01, 0x60, 0x27, 0x60, 0x81, 0xa0, 0x00, 0x02, 0x60, 0x80, 0x60, 0x22, 0x61,
+    0xa3, 0x00, 0x03, 0x81, 0x63, 0x80, 0xa2, 0x01, 0x04, 0x85, 0xa1, 0x02, 0x05, 0xa5, 0x03, 0x0f,
+    0x0f, 0x0f, 0x04, 0x25, 0x04, 0x03, 0x20, 0x44, 0x21, 0x03, 0x02, 0x20, 0x41, 0x21, 0x42, 0x21,
+    0x02, 0x01, 0x20, 0x42, 0x61, 0x22, 0x40, 0x61, 0x01, 0x01, 0x20, 0x41, 0x27, 0xa1, 0x00, 0x01,
+    0x20, 0x40, 0x27, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x29, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x28, 0x61,
+    0x80, 0xa0, 0x00, 0x01, 0x60, 0x27, 0x60, 0x80, 0xa1, 0x00, 0x02, 0x61, 0x20, 0x61, 0x20, 0x61,
+    0x80, 0xa2, 0x00, 0x03, 0x80, 0x60, 0x81, 0x61, 0x81, 0xa1, 0x01, 0x04, 0x85, 0xa1, 0x02, 0x05,
+    0xa5, 0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x25, 0x04, 0x03, 0x20, 0x44, 0x21, 0x03, 0x02, 0x20, 0x42,
+    0x22, 0x40, 0x21, 0x02, 0x01, 0x20, 0x42, 0x20, 0x62, 0x20, 0x40, 0x20, 0x60, 0x01, 0x01, 0x20,
+    0x41, 0x27, 0x80, 0xa0, 0x00, 0x01, 0x60, 0x40, 0x27, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x29, 0x60,
+    0x80, 0xa0, 0x00, 0x01, 0x60, 0x27, 0x61, 0x80, 0xa0, 0x00, 0x01, 0x60, 0x27, 0x60, 0x81, 0xa0,
+    0x00, 0x02, 0x61, 0x21, 0x61, 0x80, 0x60, 0x81, 0xa1, 0x00, 0x03, 0x80, 0x61, 0x84, 0xa1, 0x01,
+    0x04, 0x85, 0xa1, 0x02, 0x05, 0xa5, 0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x25, 0x04, 0x03, 0x20, 0x44,
+    0x21, 0x03, 0x02, 0x20, 0x44, 0x23, 0x02, 0x01, 0x20, 0x40, 0x20, 0x40, 0x22, 0x61, 0x40, 0x20,
+    0x60, 0x01, 0x01, 0x21, 0x40, 0x27, 0x80, 0xa0, 0x00, 0x01, 0x20, 0x40, 0x27, 0x60, 0x80, 0xa0,
+    0x00, 0x01, 0x29, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x28, 0x61, 0x80, 0xa0, 0x00, 0x01, 0x61, 0x26,
+    0x60, 0x81, 0xa0, 0x00, 0x02, 0x60, 0x80, 0x23, 0x83, 0xa1, 0x00, 0x03, 0x80, 0x63, 0x80, 0xa0,
+    0x80, 0xa1, 0x01, 0x04, 0x85, 0xa1, 0x02, 0x05, 0xa5, 0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x25, 0x04,
+    0x03, 0x20, 0x44, 0x21, 0x03, 0x02, 0x20, 0x46, 0x21, 0x02, 0x01, 0x20, 0x42, 0x24, 0x40, 0x20,
+    0x60, 0x01, 0x01, 0x20, 0x40, 0x20, 0x60, 0x24, 0x61, 0x80, 0xa0, 0x00, 0x01, 0x20, 0x40, 0x61,
+    0x24, 0x60, 0x81, 0xa0, 0x00, 0x01, 0x29, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x28, 0x61, 0x80, 0xa0,
+    0x00, 0x01, 0x60, 0x27, 0x60, 0x81, 0xa0, 0x00, 0x02, 0x61, 0x23, 0x61, 0x81, 0xa1, 0x00, 0x03,
+    0x81, 0x63, 0x80, 0xa2, 0x01, 0x04, 0x80, 0xa0, 0x82, 0xa2, 0x02, 0x05, 0xa5, 0x03, 0x0f, 0x0f,
+    0x0f, 0x04, 0x24, 0x60, 0x04, 0x03, 0x20, 0x44, 0x21, 0x03, 0x02, 0x20, 0x46, 0x21, 0x02, 0x01,
+    0x20, 0x42, 0x61, 0x22, 0x40, 0x20, 0x60, 0x01, 0x01, 0x20, 0x41, 0x62, 0x24, 0xa1, 0x00, 0x01,
+    0x20, 0x40, 0x20, 0x62, 0x23, 0x60, 0xa1, 0x00, 0x01, 0x29, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x28,
+    0x61, 0x80, 0xa0, 0x00, 0x01, 0x80, 0x27, 0x60, 0x81, 0xa0, 0x00, 0x02, 0x61, 0x23, 0x61, 0x81,
+    0xa1, 0x00, 0x03, 0x80, 0x64, 0x81, 0xa1, 0x01, 0x04, 0x80, 0xa1, 0x82, 0xa1, 0x02, 0x05, 0xa5,
+    0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x25, 0x04, 0x03, 0x20, 0x44, 0x21, 0x03, 0x02, 0x20, 0x46, 0x21,
+    0x02, 0x01, 0x20, 0x42, 0x21, 0x60, 0x21, 0x40, 0x20, 0x60, 0x01, 0x01, 0x20, 0x41, 0x21, 0x62,
+    0x22, 0x80, 0xa0, 0x00, 0x01, 0x60, 0x40, 0x22, 0x62, 0x21, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x29,
+    0x60, 0x80, 0xa0, 0x00, 0x01, 0x28, 0x61, 0x80, 0xa0, 0x00, 0x01, 0x80, 0x27, 0x60, 0x81, 0xa0,
+    0x00, 0x02, 0x80, 0x60, 0x23, 0x61, 0x81, 0xa1, 0x00, 0x03, 0x80, 0x64, 0x81, 0xa1, 0x01, 0x04,
+    0x82, 0xa0, 0x81, 0xa1, 0x02, 0x05, 0xa5, 0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x20, 0x60, 0x23, 0x04,
+    0x03, 0x20, 0x44, 0x21, 0x03, 0x02, 0x20, 0x46, 0x21, 0x02, 0x01, 0x20, 0x42, 0x22, 0x61, 0x40,
+    0x20, 0x60, 0x01, 0x01, 0x21, 0x40, 0x23, 0x62, 0x20, 0x80, 0xa0, 0x00, 0x01, 0x26, 0x63, 0x80,
+    0xa0, 0x00, 0x01, 0x29, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x28, 0x61, 0x80, 0xa0, 0x00, 0x01, 0x60,
+    0x27, 0x60, 0x81, 0xa0, 0x00, 0x02, 0x80, 0x60, 0x23, 0x61, 0x81, 0xa1, 0x00, 0x03, 0xa0, 0x64,
+    0x81, 0xa1, 0x01, 0x04, 0xa0, 0x82, 0xa3, 0x02, 0x05, 0xa5, 0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x21,
+    0x60, 0x20, 0x60, 0x20, 0x04, 0x03, 0x20, 0x44, 0x21, 0x03, 0x02, 0x20, 0x46, 0x21, 0x02, 0x01,
+    0x20, 0x42, 0x24, 0x40, 0x20, 0x60, 0x01, 0x01, 0x20, 0x41, 0x27, 0x80, 0xa0, 0x00, 0x01, 0x20,
+    0x40, 0x61, 0x24, 0x60, 0x81, 0xa0, 0x00, 0x01, 0x21, 0x61, 0x24, 0x60, 0x81, 0xa0, 0x00, 0x01,
+    0x21, 0x61, 0x24, 0x82, 0xa0, 0x00, 0x01, 0x60, 0x27, 0x60, 0x81, 0xa0, 0x00, 0x02, 0x61, 0x23,
+    0x61, 0x81, 0xa1, 0x00, 0x03, 0x80, 0x64, 0x81, 0xa1, 0x01, 0x04, 0x85, 0xa1, 0x02, 0x05, 0xa5,
+    0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x21, 0x60, 0x21, 0x60, 0x04, 0x03, 0x20, 0x44, 0x20, 0x60, 0x03,
+    0x02, 0x20, 0x46, 0x21, 0x02, 0x01, 0x20, 0x42, 0x24, 0x40, 0x20, 0x60, 0x01, 0x01, 0x20, 0x41,
+    0x27, 0x80, 0xa0, 0x00, 0x01, 0x20, 0x40, 0x21, 0x61, 0x23, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x22,
+    0x62, 0x23, 0x60, 0xa1, 0x00, 0x01, 0x23, 0x61, 0x22, 0x61, 0x80, 0xa0, 0x00, 0x01, 0x60, 0x27,
+    0x60, 0x81, 0xa0, 0x00, 0x02, 0x61, 0x23, 0x61, 0x81, 0xa1, 0x00, 0x03, 0x80, 0x64, 0x81, 0xa1,
+    0x01, 0x04, 0x85, 0xa1, 0x02, 0x05, 0xa5, 0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x60, 0x21, 0x60, 0x21,
+    0x04, 0x03, 0x60, 0x44, 0x21, 0x03, 0x02, 0x60, 0x46, 0x21, 0x02, 0x01, 0x60, 0x42, 0x24, 0x40,
+    0x20, 0x60, 0x01, 0x01, 0x20, 0x41, 0x27, 0x80, 0xa0, 0x00, 0x01, 0x20, 0x40, 0x22, 0x62, 0x21,
+    0x60, 0x80, 0xa0, 0x00, 0x01, 0x60, 0x23, 0x62, 0x21, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x24, 0x62,
+    0x20, 0x61, 0x80, 0xa0, 0x00, 0x01, 0x60, 0x27, 0x60, 0x81, 0xa0, 0x00, 0x02, 0x61, 0x23, 0x61,
+    0x81, 0xa1, 0x00, 0x03, 0x80, 0x64, 0x81, 0xa1, 0x01, 0x04, 0x85, 0xa1, 0x02, 0x05, 0xa5, 0x03,
+    0x0f, 0x0f, 0x0f, 0x04, 0x61, 0x21, 0x60, 0x20, 0x04, 0x03, 0x21, 0x43, 0x21, 0x03, 0x02, 0x20,
+    0x46, 0x21, 0x02, 0x01, 0x20, 0x42, 0x24, 0x40, 0x20, 0x60, 0x01, 0x01, 0x20, 0x41, 0x27, 0x80,
+    0xa0, 0x00, 0x01, 0x20, 0x40, 0x24, 0x61, 0x20, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x20, 0x60, 0x24,
+    0x63, 0x80, 0xa0, 0x00, 0x01, 0x26, 0x63, 0x80, 0xa0, 0x00, 0x01, 0x60, 0x27, 0x60, 0x81, 0xa0,
+    0x00, 0x02, 0x61, 0x23, 0x61, 0x81, 0xa1, 0x00, 0x03, 0x80, 0x64, 0x81, 0xa1, 0x01, 0x04, 0xa0,
+    0x84, 0xa1, 0x02, 0x05, 0xa5, 0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x25, 0x04, 0x03, 0x20, 0x40, 0x20,
+    0x42, 0x60, 0x20, 0x03, 0x02, 0x20, 0x40, 0x20, 0x44, 0x60, 0x20, 0x02, 0x01, 0x20, 0x42, 0x24,
+    0x40, 0x20, 0x60, 0x01, 0x01, 0x20, 0x41, 0x27, 0x80, 0xa0, 0x00, 0x01, 0x20, 0x40, 0x27, 0x60,
+    0x80, 0xa0, 0x00, 0x01, 0x29, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x21, 0x61, 0x24, 0x82, 0xa0, 0x00,
+    0x01, 0x60, 0x20, 0x61, 0x24, 0x80, 0xa0, 0x80, 0xa0, 0x00, 0x02, 0x61, 0x23, 0x61, 0x81, 0xa1,
+    0x00, 0x03, 0x80, 0x64, 0x81, 0xa1, 0x01, 0x04, 0x85, 0xa1, 0x02, 0x05, 0xa5, 0x03, 0x0f, 0x0f,
+    0x0f, 0x04, 0x25, 0x04, 0x03, 0x20, 0x40, 0x21, 0x41, 0x20, 0x60, 0x03, 0x02, 0x20, 0x46, 0x20,
+    0x60, 0x02, 0x01, 0x20, 0x42, 0x24, 0x40, 0x20, 0x80, 0x01, 0x01, 0x60, 0x41, 0x27, 0x80, 0xa0,
+    0x00, 0x01, 0x20, 0x40, 0x27, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x29, 0x60, 0x80, 0xa0, 0x00, 0x01,
+    0x22, 0x62, 0x22, 0x61, 0xa1, 0x00, 0x01, 0x60, 0x21, 0x62, 0x22, 0x60, 0x80, 0xa1, 0x00, 0x02,
+    0x61, 0x20, 0x61, 0x20, 0x61, 0x81, 0xa1, 0x00, 0x03, 0x80, 0x64, 0x81, 0xa1, 0x01, 0x04, 0x85,
+    0xa1, 0x02, 0x05, 0xa5, 0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x25, 0x04, 0x03, 0x20, 0x42, 0x20, 0x40,
+    0x21, 0x03, 0x02, 0x20, 0x46, 0x21, 0x02, 0x01, 0x60, 0x20, 0x41, 0x24, 0x40, 0x20, 0x80, 0x01,
+    0x01, 0x60, 0x41, 0x27, 0x80, 0xa0, 0x00, 0x01, 0x20, 0x40, 0x27, 0x60, 0x80, 0xa0, 0x00, 0x01,
+    0x29, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x60, 0x23, 0x62, 0x20, 0x61, 0x80, 0xa0, 0x00, 0x01, 0x60,
+    0x23, 0x62, 0x20, 0x60, 0x81, 0xa0, 0x00, 0x02, 0x61, 0x22, 0x62, 0x81, 0xa1, 0x00, 0x03, 0x80,
+    0x64, 0x81, 0xa1, 0x01, 0x04, 0x85, 0xa1, 0x02, 0x05, 0xa5, 0x03, 0x0f, 0x0f, 0x0f, 0x04, 0x25,
+    0x04, 0x03, 0x21, 0x42, 0x20, 0x60, 0x20, 0x03, 0x02, 0x21, 0x45, 0x21, 0x02, 0x01, 0x21, 0x41,
+    0x24, 0x40, 0x20, 0x60, 0x01, 0x01, 0x20, 0x41, 0x27, 0x80, 0xa0, 0x00, 0x01, 0x20, 0x40, 0x27,
+    0x60, 0x80, 0xa0, 0x00, 0x01, 0x29, 0x60, 0x80, 0xa0, 0x00, 0x01, 0x20, 0x60, 0x24, 0x61, 0x80,
+    0x60, 0x80, 0xa0, 0x00, 0x01, 0x61, 0x24, 0x61, 0x82, 0xa0, 0x00, 0x02, 0x61, 0x23, 0x83, 0xa1,
+    0x00, 0x03, 0x80, 0x64, 0x81, 0xa1, 0x01, 0x04, 0x85, 0xa1, 0x02, 0x05, 0xa5, 0x03, 0x0f
+};
+
+const uint16_t Ball::FRAME_OFFSETS[] = {
+    0, 80, 163, 248, 331, 415, 498, 585, 668, 754, 841, 929, 1015, 1103, 1190, 1276,
+    1359
 };
 
+// the buffers in which a frame is decoded
+const uint8_t Ball::FRAME_MAX_SPANS = 13;
+const uint16_t Ball::FRAME_MAX_PIXELS = 137;
+
+static_assert(BALL_COLOR_COUNT <= 7, "the runs hold at most 7 colors");
+
+// the ball stands still, and no frame has been decoded yet
+// > the indices of the pixels share the buffer of their color codes
+Ball::Ball() : frame(0), decodedFrame(-1), decodedIndexed(false) {
+    this->spans = new SpriteSpan[FRAME_MAX_SPANS];
+    this->pixels = new uint16_t[FRAME_MAX_PIXELS];
+    this->sprite = { FRAME_WIDTH, FRAME_HEIGHT, this->rows, this->spans, this->pixels, (const uint8_t*)this->pixels };
+}
+
 // a destructor must be defined here to
-// avoid potential memory leaks
+// avoid potential memory leaks... and here, the buffers
+// of the decoded frame must be released
 Ball::~Ball() {
-    // he's not doing anything special here,
-    // but it's important to think about it!
+    delete[] this->spans;
+    delete[] this->pixels;
 }
 
-// and we define the method of calculating the rendering of the ball
-void Ball::draw(uint8_t sliceY, uint8_t sliceHeight, uint16_t* buffer) {
-    // the portion of the sprite which is located within
-    // the current slice is determined along the Y axis
-    int8_t startIndex = Y_POS <= sliceY ? 0 : Y_POS - sliceY;
-    int8_t endIndex = Y_POS + FRAME_HEIGHT >= sliceY + sliceHeight ? sliceHeight - 1 : Y_POS + FRAME_HEIGHT - sliceY - 1;
-    // we prepare a variable that will receive in turn the color codes
-    // of each of the pixels that make up the sprite (in the current slice)
-    uint16_t value;
-    // coordinates of the processed pixel
-    uint8_t x,y;
-    // now we go through the portion of the sprite that is in the slice
-    // along the Y axis...
-    for (y = startIndex; y <= endIndex; y++) {
-        // and the X axis
-        for (x = X_POS; x < X_POS + FRAME_WIDTH; x++) {
-            // we will pick the color of the corresponding pixel
-            value = BITMAP[x - X_POS + (y + sliceY - Y_POS) * FRAME_WIDTH];
-            // and if it is not the transparent color
-            if (value != TRANSPARENT_COLOR) {
-                // we copy it into the buffer
-                buffer[x + y * SCREEN_WIDTH] = value;
+// the ball only overlaps the slices crossed by its sprite
+int16_t Ball::getTop() {
+    return Y_POS;
+}
+
+int16_t Ball::getBottom() {
+    return Y_POS + FRAME_HEIGHT;
+}
+
+// the ball is fixed in the center of the screen: once displayed,
+// it only needs to be redrawn when its frame changes or when the tiling
+// below it changes, which the `Renderer` takes care of
+void Ball::getChanges(int16_t& top, int16_t& bottom) {
+    if (this->decodedFrame == this->frame && this->decodedIndexed == Renderer::isIndexed()) {
+        top = bottom = 0;
+    } else {
+        this->decode(this->frame);
+        top = Y_POS;
+        bottom = Y_POS + FRAME_HEIGHT;
+    }
+}
+
+// the spots move by one step every 2^BALL_ROLL_SHIFT pixels
+// > the shifts round down, even for negative distances
+void Ball::roll(int32_t x, int32_t y) {
+    this->frame = ((y >> BALL_ROLL_SHIFT) & (BALL_ROLL_PHASES - 1)) * BALL_ROLL_PHASES + ((x >> BALL_ROLL_SHIFT) & (BALL_ROLL_PHASES - 1));
+}
+
+// the runs of the frame are expanded row after row: the consecutive runs
+// of opaque pixels are gathered in the same span, whatever their colors,
+// which are expanded into color codes or indices depending on the mode
+void Ball::decode(uint8_t frame) {
+    static_assert(sizeof(FRAME_OFFSETS) == (BALL_FRAME_COUNT + 1) * sizeof(uint16_t), "the frames must be compressed again");
+    const uint8_t* run = FRAME_RUNS + FRAME_OFFSETS[frame];
+    bool indexed = Renderer::isIndexed();
+    uint8_t* indices = (uint8_t*)this->pixels;
+    uint8_t spanCount = 0;
+    uint16_t pixelCount = 0;
+    for (uint8_t y = 0; y < FRAME_HEIGHT; y++) {
+        this->rows[y] = spanCount;
+        // flag which tells if the last span ends at `x`
+        bool open = false;
+        for (uint8_t x = 0; x < FRAME_WIDTH; run++) {
+            uint8_t code = *run >> 5;
+            uint8_t length = (*run & 31) + 1;
+            x += length;
+            if (code == 0) {
+                open = false;
+                continue;
+            }
+            if (!open) {
+                this->spans[spanCount++] = { (uint8_t)(x - length), 0, pixelCount };
+                open = true;
             }
+            this->spans[spanCount - 1].length += length;
+            if (indexed) {
+                memset(indices + pixelCount, BALL_COLOR_INDEX + code - 1, length);
+            } else {
+                uint16_t color = ScreenShader::BALL_COLORS[code - 1];
+                for (uint8_t i = 0; i < length; i++) this->pixels[pixelCount + i] = color;
+            }
+            pixelCount += length;
         }
     }
+    this->rows[FRAME_HEIGHT] = spanCount;
+    this->decodedFrame = frame;
+    this->decodedIndexed = indexed;
+}
+
+void Ball::placeShadow(DropShadow* shadow) {
+    shadow->moveTo(X_POS + FRAME_WIDTH / 2 + BALL_SHADOW_SHIFT_X, Y_POS + FRAME_HEIGHT / 2 + BALL_SHADOW_SHIFT_Y);
+}
+
+bool Ball::isReentrant() {
+    return true;
+}
+
+// and we define the method of calculating the rendering of the ball
+void Ball::draw(screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) {
+    // the sprite only copies the runs of opaque pixels
+    // which are located within the current slice
+    this->sprite.draw(X_POS, Y_POS, sliceY, sliceHeight, buffer);
+}
+
+void Ball::drawIndexed(screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) {
+    this->sprite.drawIndexed(X_POS, Y_POS, sliceY, sliceHeight, buffer);
 }
\ No newline at end of file
@@ -2,6 +2,25 @@
 #define SHADING_EFFECT_BALL
 
 #include "Renderable.h"
+#include "Sprite.h"
+#include "DropShadow.h"
+
+// the shadow that the ball drops on the tiling: a disc a little smaller
+// than the ball, whose edge fades out over a few pixels, shifted towards
+// the bottom right so that it shows around the ball
+#define BALL_SHADOW_RADIUS 6
+#define BALL_SHADOW_BLUR 4
+#define BALL_SHADOW_STRENGTH 144
+#define BALL_SHADOW_SHIFT_X 3
+#define BALL_SHADOW_SHIFT_Y 4
+
+// the rolling animation of the ball: its surface is marked with spots, which
+// move by one step every 2^BALL_ROLL_SHIFT pixels travelled by the ball on the
+// floor, along each axis... the frames hold all the combinations of the
+// BALL_ROLL_PHASES steps along X and along Y (the spots repeat beyond them)
+#define BALL_ROLL_PHASES 4
+#define BALL_ROLL_SHIFT 1
+#define BALL_FRAME_COUNT (BALL_ROLL_PHASES * BALL_ROLL_PHASES)
 
 // here is how to declare the fact that the `Ball` class
 // fulfills the contract defined by the `Renderable` interface
@@ -11,25 +30,77 @@ class Ball : public Renderable
     private:
 
         // the descriptive parameters of the sprite
-        static const uint8_t FRAME_WIDTH;
-        static const uint8_t FRAME_HEIGHT;
-        static const uint16_t TRANSPARENT_COLOR;
-        // the pixel map obtained with the transcoding tool
-        static const uint16_t BITMAP[];
-        
+        static constexpr uint8_t FRAME_WIDTH = 16;
+        static constexpr uint8_t FRAME_HEIGHT = 16;
+
+        // the frames obtained with the transcoding tool, compressed into runs
+        // of codes of the colors of the ball in the screen palette: the frame `f`
+        // is made of the runs `FRAME_RUNS[FRAME_OFFSETS[f]...FRAME_OFFSETS[f+1]-1]`,
+        // each one holding its code in its 3 upper bits (0 for the transparent
+        // pixels, `c` for the color `BALL_COLOR_INDEX + c - 1`) and its length
+        // minus 1 in its 5 lower bits
+        static const uint8_t FRAME_RUNS[];
+        static const uint16_t FRAME_OFFSETS[];
+        // the largest numbers of spans and of opaque pixels of a frame,
+        // given by the transcoding tool as well
+        static const uint8_t FRAME_MAX_SPANS;
+        static const uint16_t FRAME_MAX_PIXELS;
+
         // the coordinates of the ball, which are constant
         // since the ball is fixed in the center of the screen
-        static const uint8_t X_POS;
-        static const uint8_t Y_POS;
+        static const screen_x_t X_POS;
+        static const screen_y_t Y_POS;
+
+        // only the current frame is decoded in RAM, compiled into runs
+        // of opaque pixels as the static sprites are (see `Sprite`)...
+        // its opaque pixels are only decoded for the current mode of the
+        // `Renderer`: the same buffer holds either their color codes or
+        // their indices in the screen palette
+        uint16_t rows[FRAME_HEIGHT + 1];
+        SpriteSpan* spans;
+        uint16_t* pixels;
+        Sprite sprite;
+
+        // the frame to display, and the one held in the cache
+        // (-1 until the first one is decoded), with its mode
+        uint8_t frame;
+        int8_t decodedFrame;
+        bool decodedIndexed;
+
+        // decodes a frame into the cache
+        void decode(uint8_t frame);
 
     public:
 
+        // the constructor
+        Ball();
+
         // a destructor must be declared here to
         // avoid potential memory leaks
         ~Ball();
 
+        // the vertical extent of the sprite on the screen
+        int16_t getTop() override;
+        int16_t getBottom() override;
+
+        // the ball does not move, so it only has to be displayed again when
+        // its frame (or the mode of the renderer) changes... the frame is then
+        // decoded, once for all the slices
+        void getChanges(int16_t& top, int16_t& bottom) override;
+
+        // rolls the ball by the distance it has travelled on the floor since the
+        // beginning (the offset of the tiling, which integrates its velocity)
+        void roll(int32_t x, int32_t y);
+
+        // places the shadow of the ball under it
+        void placeShadow(DropShadow* shadow);
+
+        // the ball only reads its decoded frame while drawing
+        bool isReentrant() override;
+
         // the famous method of fulfilling the `Renderable` contract
-        void draw(uint8_t sliceY, uint8_t sliceHeight, uint16_t* buffer) override;
+        void draw(screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) override;
+        void drawIndexed(screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) override;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "ChunkCache.h"
+
+ChunkCache::ChunkCache(TileMap* map, uint8_t tileCount) : tileCount(tileCount), reads(0) {
+    this->setMap(map);
+}
+
+ChunkCache::~ChunkCache() {
+    // the map does not belong to the cache
+    this->map = NULL;
+}
+
+void ChunkCache::setMap(TileMap* map) {
+    this->map = map;
+    memset(this->loaded, 0, sizeof(this->loaded));
+    memset(this->window, NO_CHUNK, sizeof(this->window));
+    this->windowX = 0;
+    this->windowY = 0;
+}
+
+void ChunkCache::prepare(int32_t tx0, int32_t ty0, int32_t tx1, int32_t ty1) {
+    // the chunks covering the rectangle of tiles
+    // > the shifts round down, even for negative coordinates
+    int32_t cx0 = tx0 >> CHUNK_SIZE_POWER_OF_TWO;
+    int32_t cy0 = ty0 >> CHUNK_SIZE_POWER_OF_TWO;
+    int32_t columns = (tx1 >> CHUNK_SIZE_POWER_OF_TWO) - cx0 + 1;
+    int32_t rows = (ty1 >> CHUNK_SIZE_POWER_OF_TWO) - cy0 + 1;
+    if (columns > CHUNK_CACHE_COLUMNS) columns = CHUNK_CACHE_COLUMNS;
+    if (rows > CHUNK_CACHE_ROWS) rows = CHUNK_CACHE_ROWS;
+
+    this->windowX = cx0;
+    this->windowY = cy0;
+    memset(this->window, NO_CHUNK, sizeof(this->window));
+
+    // the slots already holding a chunk of the new window are kept...
+    bool used[CHUNK_SLOTS] = { false };
+    for (uint8_t s = 0; s < CHUNK_SLOTS; s++) {
+        if (!this->loaded[s]) continue;
+        int32_t c = this->chunkX[s] - cx0;
+        int32_t r = this->chunkY[s] - cy0;
+        if (c >= 0 && c < columns && r >= 0 && r < rows) {
+            this->window[r][c] = s;
+            used[s] = true;
+        }
+    }
+
+    // ...and the chunks which have just entered the window
+    // are read into the slots that are no longer needed
+    uint8_t s = 0;
+    for (uint8_t r = 0; r < rows; r++) {
+        for (uint8_t c = 0; c < columns; c++) {
+            if (this->window[r][c] != NO_CHUNK) continue;
+            while (used[s]) s++;
+            this->map->readChunk(cx0 + c, cy0 + r, this->tiles[s]);
+            for (uint8_t t = 0; t < CHUNK_SIZE * CHUNK_SIZE; t++) {
+                if (this->tiles[s][t] >= this->tileCount) this->tiles[s][t] = 0;
+            }
+            this->chunkX[s] = cx0 + c;
+            this->chunkY[s] = cy0 + r;
+            this->loaded[s] = true;
+            this->window[r][c] = s;
+            used[s] = true;
+            this->reads++;
+        }
+    }
+}
+
+uint32_t ChunkCache::getReadCount() {
+    return this->reads;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef SHADING_EFFECT_CHUNK_CACHE
+#define SHADING_EFFECT_CHUNK_CACHE
+
+#include "TileMap.h"
+#include "constants.h"
+
+// the smallest tiles which the window of the cache is sized for
+#define CHUNK_CACHE_TILE_SIZE 16
+
+// the window of chunks kept in RAM around the camera...
+// it must cover the tiles visible on the screen wherever the camera is,
+// i.e. (visible tiles + 1) <= (columns - 1) * CHUNK_SIZE along each axis:
+// with 16x16 tiles on a 160x128 screen, 3x3 chunks of 8x8 tiles (576 bytes),
+// and 4x4 chunks on a 320x240 panel
+#define CHUNK_CACHE_COLUMNS ((SCREEN_WIDTH / CHUNK_CACHE_TILE_SIZE + 2 + CHUNK_SIZE - 1) / CHUNK_SIZE + 1)
+#define CHUNK_CACHE_ROWS ((SCREEN_HEIGHT / CHUNK_CACHE_TILE_SIZE + 2 + CHUNK_SIZE - 1) / CHUNK_SIZE + 1)
+#define CHUNK_SLOTS (CHUNK_CACHE_COLUMNS * CHUNK_CACHE_ROWS)
+
+// the marker of a window cell which does not need any chunk
+#define NO_CHUNK 0xff
+
+// a cache of the chunks of a `TileMap` located around the camera:
+// when the camera moves, only the chunks which enter the window are read
+// from the map, and the tiles of the window are then read in constant time
+class ChunkCache
+{
+    private:
+
+        // the map being streamed, and the number of tiles of the tileset
+        TileMap* map;
+        uint8_t tileCount;
+
+        // the chunks held in the cache, and their coordinates
+        uint8_t tiles[CHUNK_SLOTS][CHUNK_SIZE * CHUNK_SIZE];
+        int32_t chunkX[CHUNK_SLOTS];
+        int32_t chunkY[CHUNK_SLOTS];
+        bool loaded[CHUNK_SLOTS];
+
+        // the coordinates of the chunk at the top left of the window,
+        // and the slot holding each chunk of the window
+        int32_t windowX,windowY;
+        uint8_t window[CHUNK_CACHE_ROWS][CHUNK_CACHE_COLUMNS];
+
+        // the number of chunks read from the map since the beginning
+        uint32_t reads;
+
+    public:
+
+        // the tile indices of the map are checked against the `tileCount`
+        // tiles of the tileset when their chunk is read: an invalid index
+        // (a corrupted byte of a map stored in flash or on the SD card)
+        // is replaced by the tile 0, so that the tiling never reads
+        // past the end of its tables
+        ChunkCache(TileMap* map, uint8_t tileCount);
+        ~ChunkCache();
+
+        // changes the map being streamed (the cache is emptied)
+        void setMap(TileMap* map);
+
+        // makes sure that all the chunks covering the tiles from (tx0,ty0)
+        // to (tx1,ty1) included are loaded... it must be called before
+        // reading these tiles, once per frame
+        void prepare(int32_t tx0, int32_t ty0, int32_t tx1, int32_t ty1);
+
+        // the index of the tile (tx,ty), which must have been prepared
+        inline uint8_t getTile(int32_t tx, int32_t ty) {
+            uint8_t slot = this->window[(ty >> CHUNK_SIZE_POWER_OF_TWO) - this->windowY][(tx >> CHUNK_SIZE_POWER_OF_TWO) - this->windowX];
+            return this->tiles[slot][((ty & (CHUNK_SIZE - 1)) << CHUNK_SIZE_POWER_OF_TWO) + (tx & (CHUNK_SIZE - 1))];
+        }
+
+        // the number of chunks read from the map since the beginning
+        uint32_t getReadCount();
+};
+
+#endif
\ No newline at end of file
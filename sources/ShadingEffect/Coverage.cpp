@@ -0,0 +1,52 @@
+#include "Coverage.h"
+
+void CoverageMask::clear(uint8_t rows) {
+    memset(this->bits, 0, rows * COVERAGE_WORDS * sizeof(uint32_t));
+}
+
+void CoverageMask::cover(uint8_t row, int16_t x0, int16_t x1) {
+    uint32_t* words = this->bits[row];
+    while (x0 < x1) {
+        // the bits of the range which fall in the word of `x0`
+        uint8_t shift = x0 & 31;
+        uint8_t count = 32 - shift;
+        if (count > x1 - x0) count = x1 - x0;
+        words[x0 >> 5] |= (count == 32 ? 0xffffffff : (((uint32_t)1 << count) - 1)) << shift;
+        x0 += count;
+    }
+}
+
+void CoverageMask::coverRow(uint8_t row) {
+    memset(this->bits[row], 0xff, COVERAGE_WORDS * sizeof(uint32_t));
+}
+
+// the words are scanned 32 pixels at a time, and the boundaries of the runs
+// are located in them by counting their trailing zeros
+bool CoverageMask::nextGap(uint8_t row, int16_t& x0, int16_t& x1, int16_t end) const {
+    const uint32_t* words = this->bits[row];
+    int16_t x = x0;
+
+    // the first uncovered pixel...
+    while (x < end) {
+        uint32_t free = ~words[x >> 5] >> (x & 31);
+        if (free) {
+            x += __builtin_ctz(free);
+            break;
+        }
+        x = (x | 31) + 1;
+    }
+    if (x >= end) return false;
+    x0 = x;
+
+    // ...and the first covered pixel after it
+    while (x < end) {
+        uint32_t covered = words[x >> 5] >> (x & 31);
+        if (covered) {
+            x += __builtin_ctz(covered);
+            break;
+        }
+        x = (x | 31) + 1;
+    }
+    x1 = x < end ? x : end;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef SHADING_EFFECT_COVERAGE
+#define SHADING_EFFECT_COVERAGE
+
+#include <Gamebuino-Meta.h>
+#include "Renderer.h"
+#include "constants.h"
+
+// the tallest slice that can be configured, and the number
+// of 32-bit words needed to hold a row of the screen
+#define COVERAGE_ROWS MAX_SLICE_HEIGHT
+#define COVERAGE_WORDS ((SCREEN_WIDTH + 31) >> 5)
+
+// the pixels of the current slice which have already been drawn
+// by an opaque renderable, one bit per pixel (in the front-to-back mode
+// of the `Renderer`, see `Renderer::setFrontToBack()`)...
+// a farther renderable only has to fill the gaps left between them
+class CoverageMask
+{
+    private:
+
+        uint32_t bits[COVERAGE_ROWS][COVERAGE_WORDS];
+
+    public:
+
+        // nothing is covered in the first `rows` rows
+        void clear(uint8_t rows);
+
+        // the pixels [x0, x1) of the row `row` of the slice are covered
+        void cover(uint8_t row, int16_t x0, int16_t x1);
+        void coverRow(uint8_t row);
+
+        // looks for the next run of uncovered pixels of the row, starting at `x0`
+        // and stopping at `end`... on return, the run is [x0, x1)
+        // > returns false if all the pixels up to `end` are covered
+        bool nextGap(uint8_t row, int16_t& x0, int16_t& x1, int16_t end = SCREEN_WIDTH) const;
+};
+
+#endif
\ No newline at end of file
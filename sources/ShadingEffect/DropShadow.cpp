@@ -0,0 +1,62 @@
+#include "DropShadow.h"
+
+// the attenuation is computed twice: once to count the shadowed pixels,
+// and once to store them
+DropShadow::DropShadow(uint8_t radius, uint8_t blur, uint8_t strength) : x(0), y(0) {
+    uint8_t extent = radius + blur;
+    this->size = 2 * extent + 1;
+    this->spans = new SpriteSpan[this->size];
+
+    // the attenuation is full up to `radius` and vanishes at `extent`
+    uint16_t inner2 = radius * radius;
+    uint16_t outer2 = extent * extent;
+    uint16_t count = 0;
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        if (pass) this->attenuation = new uint8_t[count];
+        count = 0;
+        for (uint8_t row = 0; row < this->size; row++) {
+            int16_t dy = row - extent;
+            SpriteSpan& span = this->spans[row];
+            span.x = 0;
+            span.length = 0;
+            span.pixel = count;
+            for (uint8_t column = 0; column < this->size; column++) {
+                int16_t dx = column - extent;
+                uint16_t d2 = dx * dx + dy * dy;
+                if (d2 >= outer2) continue;
+                // the disc is convex, so the shadowed pixels of a row are contiguous
+                if (span.length == 0) span.x = column;
+                span.length++;
+                if (pass) {
+                    this->attenuation[count] = d2 <= inner2 ? strength : (uint32_t)strength * (outer2 - d2) / (outer2 - inner2);
+                }
+                count++;
+            }
+        }
+    }
+}
+
+DropShadow::~DropShadow() {
+    delete[] this->spans;
+    delete[] this->attenuation;
+}
+
+void DropShadow::moveTo(int16_t x, int16_t y) {
+    this->x = x - this->size / 2;
+    this->y = y - this->size / 2;
+}
+
+int16_t DropShadow::getTop() const {
+    return this->y;
+}
+
+int16_t DropShadow::getBottom() const {
+    return this->y + this->size;
+}
+
+const uint8_t* DropShadow::getRow(screen_y_t y, int16_t& x0, int16_t& x1) const {
+    const SpriteSpan& span = this->spans[y - this->y];
+    x0 = this->x + span.x;
+    x1 = x0 + span.length - 1;
+    return this->attenuation + span.pixel;
+}
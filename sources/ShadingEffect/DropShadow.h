@@ -0,0 +1,52 @@
+#ifndef SHADING_EFFECT_DROP_SHADOW
+#define SHADING_EFFECT_DROP_SHADOW
+
+#include <Gamebuino-Meta.h>
+#include "Sprite.h"
+#include "constants.h"
+
+// the shadow dropped on the tiling by a round object (the ball): a disc whose
+// edge fades out, which darkens the pixels below it by lowering their
+// brightness levels... the attenuation of its pixels is precomputed once
+// and for all, and compiled into one run per row, as the opaque pixels of
+// a sprite (see `SpriteSpan`), so that the tiling only has to add it to
+// the brightness levels of the rows it crosses
+class DropShadow
+{
+    private:
+
+        // the size of the bounding box of the shadow
+        uint8_t size;
+        // the run of shadowed pixels of each row (its `length` is zero
+        // if the row is not shadowed), and their attenuation on `LUX_BITS`
+        SpriteSpan* spans;
+        uint8_t* attenuation;
+
+        // the position of the top left corner of the bounding box on the screen
+        int16_t x,y;
+
+    public:
+
+        // a disc of radius `radius`, whose attenuation is `strength` in the
+        // middle and falls to zero over the next `blur` pixels... as for the
+        // halo of the tiling, it decreases linearly with the square of the distance
+        DropShadow(uint8_t radius, uint8_t blur, uint8_t strength);
+        ~DropShadow();
+
+        // centers the shadow on the given pixel of the screen
+        // > the tiling must be given the shadow again after it moves
+        // > (see `BasicTiling::setShadow()`), so that it is redrawn
+        void moveTo(int16_t x, int16_t y);
+
+        // the vertical extent of the shadow on the screen
+        int16_t getTop() const;
+        int16_t getBottom() const;
+
+        // the attenuation of the pixels of the screen row `y` (which must lie
+        // between `getTop()` and `getBottom()`), and the span [x0, x1] of the
+        // shadowed pixels of the row: the attenuation of the pixel `x` is
+        // found at `row[x - x0]`... x0 > x1 if the row is not shadowed
+        const uint8_t* getRow(screen_y_t y, int16_t& x0, int16_t& x1) const;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SHADING_EFFECT_FIXED
+#define SHADING_EFFECT_FIXED
+
+#include <Gamebuino-Meta.h>
+
+// the SAMD21 has no floating-point unit: each operation on a `float`
+// is emulated by a call to a software routine... so the kinematics
+// are rather computed on fixed-point numbers, simply stored in integers
+// whose 12 least significant bits represent the fractional part (Q19.12)
+// > the results are then strictly identical on the console and on the host
+typedef int32_t fixed_t;
+
+#define FIXED_SHIFT 12
+#define FIXED_ONE ((fixed_t)1 << FIXED_SHIFT)
+
+// converts a constant into a fixed-point number (rounded to the nearest)
+// > it is meant for constants only, so that the conversion is done by the compiler
+#define FIXED(x) ((fixed_t)((x) * FIXED_ONE + ((x) < 0 ? -.5 : .5)))
+
+// the product of two fixed-point numbers, rounded to the nearest
+// > the intermediate product `a * b` must fit in 32 bits
+static inline fixed_t fixedMul(fixed_t a, fixed_t b) {
+    return (a * b + (FIXED_ONE >> 1)) >> FIXED_SHIFT;
+}
+
+// the integer part of a fixed-point number (rounded down)
+static inline int32_t fixedFloor(fixed_t a) {
+    return a >> FIXED_SHIFT;
+}
+
+// the fractional part of a fixed-point number, between 0 and FIXED_ONE - 1
+static inline fixed_t fixedFraction(fixed_t a) {
+    return a & (FIXED_ONE - 1);
+}
+
+#endif
\ No newline at end of file
@@ -1,25 +1,54 @@
 #include "GameEngine.h"
 #include "Renderer.h"
+#include "ScreenPalette.h"
 
 // always initialize a pointer to NULL
 Tiling* GameEngine::tiling = NULL;
 Ball* GameEngine::ball = NULL;
+DropShadow* GameEngine::shadow = NULL;
+Sparks* GameEngine::sparks = NULL;
+LightMap* GameEngine::lightMap = NULL;
+
+uint32_t GameEngine::lastFrame = 0;
+int32_t GameEngine::accumulator = 0;
+uint8_t GameEngine::droppedFrames = 0;
+FrameStats GameEngine::stats;
 
 void GameEngine::init() {
     // instantiation of the tiling
     tiling = new Tiling();
     // instantiation of the ball
     ball = new Ball();
+    // its shadow darkens the tiling under it
+    shadow = new DropShadow(BALL_SHADOW_RADIUS, BALL_SHADOW_BLUR, BALL_SHADOW_STRENGTH);
+    ball->placeShadow(shadow);
+    tiling->setShadow(shadow);
+    // and of the sparks
+    sparks = new Sparks();
+
+    // the colors of the indexed mode of the renderer
+    // (see `Renderer::configure()`)
+    Renderer::setPalette(ScreenPalette::COLORMAP);
 
     // registration of observers
-    // with the rendering engine
-    Renderer::subscribe(tiling);
-    Renderer::subscribe(ball);
+    // with the rendering engine:
+    // the tiling in the background, the ball above it,
+    // and the sparks in the foreground
+    Renderer::subscribe(tiling, 0);
+    Renderer::subscribe(ball, 1);
+    Renderer::subscribe(sparks, 2);
+
+    // the simulation starts now
+    lastFrame = micros();
+    accumulator = 0;
+    resetStats();
 }
 
-void GameEngine::tick() {
+void GameEngine::step() {
 
-    // interception of user events
+    // interception of user events...
+    // the buttons are sampled once per frame, so a button held down
+    // keeps pushing the tiling at each step of the frame
 
     if (gb.buttons.repeat(BUTTON_LEFT, 1)) {
         tiling->left();
@@ -42,6 +71,95 @@ void GameEngine::tick() {
     // to perform these calculations
     tiling->tick();
 
+    // the ball rolls by the distance the tiling has travelled under it
+    ball->roll(tiling->getOffsetX(), tiling->getOffsetY());
+
+    // as well as the motion of the sparks
+    sparks->tick();
+}
+
+void GameEngine::tick() {
+    // the time elapsed since the previous frame is added
+    // to the time which remains to be simulated
+    uint32_t now = micros();
+    uint32_t frameUs = now - lastFrame;
+    lastFrame = now;
+    accumulator += frameUs;
+
+    // a burst of sparks is thrown once per press of the button,
+    // however many steps the frame is made of
+    if (gb.buttons.pressed(BUTTON_A)) {
+        sparks->burst(SCREEN_WIDTH / 2 - 1, SCREEN_HEIGHT / 2 - 1);
+    }
+
+    // the B button switches the dithering of the lighting on and off
+    if (gb.buttons.pressed(BUTTON_B)) {
+        tiling->setDithering(!tiling->isDithering());
+    }
+
+    // the simulation advances by as many fixed steps as this time allows
+    uint8_t steps = 0;
+    while (accumulator + SIMULATION_STEP_TOLERANCE_US >= SIMULATION_STEP_US && steps < MAX_STEPS_PER_FRAME) {
+        step();
+        accumulator -= SIMULATION_STEP_US;
+        steps++;
+        // the last slices of the previous frame are sent in the meantime
+        Renderer::poll();
+    }
+
+    // when it is too far behind, the simulation slows down rather than
+    // trying to catch up with a delay which would only grow
+    if (accumulator >= SIMULATION_STEP_US) {
+        accumulator = SIMULATION_STEP_US - 1;
+    }
+
+    stats.frames++;
+    stats.steps += steps;
+    stats.lastFrameUs = frameUs;
+    if (frameUs > stats.maxFrameUs) stats.maxFrameUs = frameUs;
+    stats.meanFrameUs += ((int32_t)frameUs - (int32_t)stats.meanFrameUs) / 16;
+
+    // the frame is over budget when the simulation had to catch up with
+    // several steps: its rendering is then skipped to save time,
+    // unless the screen has not been refreshed for too long
+    if (steps > 1 && droppedFrames < MAX_DROPPED_FRAMES) {
+        droppedFrames++;
+        stats.dropped++;
+        return;
+    }
+    droppedFrames = 0;
+
     // performs rendering of the game scene
+    uint32_t start = micros();
     Renderer::draw();
+    stats.renderUs = micros() - start;
+}
+
+void GameEngine::setMap(TileMap* map) {
+    tiling->setMap(map);
+}
+
+uint32_t GameEngine::getChunkReadCount() {
+    return tiling->getChunkReadCount();
+}
+
+void GameEngine::setLightMap(LightMap* lights) {
+    if (lightMap) Renderer::unsubscribe(lightMap);
+    lightMap = lights;
+    if (lights) Renderer::subscribe(lights, -1);
+    tiling->setLightMap(lights);
+}
+
+const FrameStats& GameEngine::getStats() {
+    return stats;
+}
+
+void GameEngine::resetStats() {
+    stats.frames = 0;
+    stats.steps = 0;
+    stats.dropped = 0;
+    stats.lastFrameUs = 0;
+    stats.maxFrameUs = 0;
+    stats.meanFrameUs = SIMULATION_STEP_US;
+    stats.renderUs = 0;
 }
\ No newline at end of file
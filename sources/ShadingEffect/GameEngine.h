@@ -4,6 +4,40 @@
 // we will define the `Tiling` class just after...
 #include "Tiling.h"
 #include "Ball.h"
+#include "Sparks.h"
+
+// the simulation advances by fixed steps of 40 ms (25 steps per second),
+// whatever the frame rate of the rendering: the motion equations
+// of the tiling have been tuned for this rate
+#define SIMULATION_STEP_US 40000
+
+// the frame pacing of `gb.update()` jitters a little: a frame which comes
+// slightly early is still given its step, instead of none followed by two
+#define SIMULATION_STEP_TOLERANCE_US (SIMULATION_STEP_US / 8)
+
+// beyond this number of steps per frame, the simulation gives up catching up
+// with the real time (it would otherwise take longer and longer to do so)
+#define MAX_STEPS_PER_FRAME 4
+
+// the maximum number of consecutive frames whose rendering can be skipped
+// to let the simulation catch up, so that the screen is still refreshed
+#define MAX_DROPPED_FRAMES 2
+
+// the frame-time statistics of the scheduler
+struct FrameStats
+{
+    // the number of frames, of simulation steps and of skipped renderings
+    uint32_t frames;
+    uint32_t steps;
+    uint32_t dropped;
+    // the duration of the last frame, the longest one,
+    // and their moving average (over about 16 frames), in microseconds
+    uint32_t lastFrameUs;
+    uint32_t maxFrameUs;
+    uint32_t meanFrameUs;
+    // the duration of the last rendering, in microseconds
+    uint32_t renderUs;
+};
 
 class GameEngine
 {
@@ -15,6 +49,29 @@ class GameEngine
         // a pointer to the instance of the ball
         static Ball* ball;
 
+        // and to the shadow it drops on the tiling
+        static DropShadow* shadow;
+
+        // the sparks thrown by the ball when the A button is pressed
+        static Sparks* sparks;
+
+        // the light map which replaces the halo of the tiling, if any
+        static LightMap* lightMap;
+
+        // the instant of the previous frame, and the time which
+        // remains to be simulated (it may be slightly negative,
+        // see `SIMULATION_STEP_TOLERANCE_US`)
+        static uint32_t lastFrame;
+        static int32_t accumulator;
+
+        // the number of consecutive frames which were not rendered
+        static uint8_t droppedFrames;
+
+        static FrameStats stats;
+
+        // a step of the simulation
+        static void step();
+
     public:
 
         // initialization
@@ -22,6 +79,20 @@ class GameEngine
 
         // entry point of the main control loop
         static void tick();
+
+        // the map displayed by the tiling (the checkerboard by default),
+        // and the number of its chunks read since the beginning
+        static void setMap(TileMap* map);
+        static uint32_t getChunkReadCount();
+
+        // the tiling is lit by the given light map instead of its halo (NULL
+        // brings the halo back)... the map is subscribed to the renderer
+        // behind all the other observers, so that it is prepared first
+        static void setLightMap(LightMap* lights);
+
+        // the frame-time statistics, which can be reset at any time
+        static const FrameStats& getStats();
+        static void resetStats();
 };
 
 #endif
\ No newline at end of file
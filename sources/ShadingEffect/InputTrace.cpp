@@ -0,0 +1,31 @@
+#include "InputTrace.h"
+
+#if INPUT_TRACE_ENABLED
+
+// no frame has been sampled yet
+uint8_t InputTrace::mask = 0;
+uint16_t InputTrace::frames = 0;
+
+void InputTrace::sample() {
+    // a button is held down from the frame it is pressed,
+    // until the frame it is released (excluded)
+    uint8_t held = 0;
+    for (uint8_t i = 0; i < 8; i++) {
+        uint16_t state = gb.buttons.states[i];
+        if (state != 0 && state != 0xffff) held |= 1 << i;
+    }
+
+    // the run goes on as long as the same buttons are held
+    if (held != mask || frames == 0xffff) {
+        flush();
+        mask = held;
+    }
+    frames++;
+}
+
+void InputTrace::flush() {
+    if (frames) SerialUSB.printf("%u %02x\n", frames, mask);
+    frames = 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef SHADING_EFFECT_INPUT_TRACE
+#define SHADING_EFFECT_INPUT_TRACE
+
+#include <Gamebuino-Meta.h>
+
+// the recording of the input trace is disabled by default: its methods
+// are then empty and inlined... set it to 1 to enable it (or pass
+// -DINPUT_TRACE_ENABLED=1 to the compiler)
+#ifndef INPUT_TRACE_ENABLED
+#define INPUT_TRACE_ENABLED 0
+#endif
+
+// the trace records the buttons held down at each frame, to be replayed
+// on the host by the `replay` tool... it is streamed over `SerialUSB`
+// as text, one line per run of frames during which the same buttons are held:
+//   <number of frames> <mask of the buttons in hexadecimal>
+// where the bit `n` of the mask stands for the button `n` of the library:
+//   down = 0x01, left = 0x02, right = 0x04, up = 0x08,
+//   a = 0x10, b = 0x20, menu = 0x40, home = 0x80
+// > the lines starting with '#' are comments
+
+class InputTrace
+{
+#if INPUT_TRACE_ENABLED
+
+    private:
+
+        // the current run of frames
+        static uint8_t mask;
+        static uint16_t frames;
+
+    public:
+
+        // samples the buttons, once per frame after `gb.update()`
+        static void sample();
+        // streams the current run over the serial port
+        static void flush();
+
+#else
+
+    public:
+
+        static inline void sample() {}
+        static inline void flush() {}
+
+#endif
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,206 @@
+#include <Gamebuino-Meta.h>
+#include "LightMap.h"
+#include "Tiling.h"
+
+// the size of a cell of the map, in pixels
+#define CELL_SIZE (1 << LIGHT_MAP_SHIFT)
+
+// no light is lit yet
+LightMap::LightMap() : cellY(0), cellRows(0), preparedY(-1), preparedHeight(0), preparedVersion(0), version(0), rowY(-1), changeTop(0), changeBottom(0) {
+    memset(this->lights, 0, sizeof(this->lights));
+    memset(this->cells, 0, sizeof(this->cells));
+}
+
+// a destructor must be defined here to
+// avoid potential memory leaks
+LightMap::~LightMap() {
+    // he's not doing anything special here,
+    // but it's important to think about it!
+}
+
+// the rows lit by a light must be redrawn when it changes...
+// a cell also lights the pixels which separate it from its neighbours
+void LightMap::invalidate(const Light& light) {
+    this->version++;
+    int16_t top = light.y - light.radius - CELL_SIZE;
+    int16_t bottom = light.y + light.radius + CELL_SIZE;
+    if (this->changeTop >= this->changeBottom) {
+        this->changeTop = top;
+        this->changeBottom = bottom;
+    } else {
+        if (top < this->changeTop) this->changeTop = top;
+        if (bottom > this->changeBottom) this->changeBottom = bottom;
+    }
+}
+
+int8_t LightMap::add(int16_t x, int16_t y, uint8_t radius, uint8_t intensity) {
+    if (radius == 0) return NO_LIGHT;
+    for (int8_t i = 0; i < MAX_LIGHTS; i++) {
+        Light& light = this->lights[i];
+        if (!light.active) {
+            light.x = x;
+            light.y = y;
+            light.radius = radius;
+            light.radius2 = radius * radius;
+            light.inverse = 65536 / light.radius2;
+            light.intensity = intensity;
+            light.active = true;
+            this->invalidate(light);
+            return i;
+        }
+    }
+    return NO_LIGHT;
+}
+
+void LightMap::move(int8_t light, int16_t x, int16_t y) {
+    Light& l = this->lights[light];
+    if (l.x == x && l.y == y) return;
+    // both the rows it leaves and the rows it reaches have changed
+    this->invalidate(l);
+    l.x = x;
+    l.y = y;
+    this->invalidate(l);
+}
+
+void LightMap::setIntensity(int8_t light, uint8_t intensity) {
+    Light& l = this->lights[light];
+    if (l.intensity == intensity) return;
+    l.intensity = intensity;
+    this->invalidate(l);
+}
+
+void LightMap::remove(int8_t light) {
+    Light& l = this->lights[light];
+    if (!l.active) return;
+    l.active = false;
+    this->invalidate(l);
+}
+
+void LightMap::getChanges(int16_t& top, int16_t& bottom) {
+    top = this->changeTop;
+    bottom = this->changeBottom;
+    this->changeTop = this->changeBottom = 0;
+}
+
+void LightMap::draw(screen_y_t sliceY, uint8_t sliceHeight, uint16_t*) {
+    this->prepare(sliceY, sliceHeight);
+}
+
+void LightMap::drawIndexed(screen_y_t sliceY, uint8_t sliceHeight, uint8_t*) {
+    this->prepare(sliceY, sliceHeight);
+}
+
+// the lights are accumulated in the cells which cover the slice
+void LightMap::prepare(screen_y_t sliceY, uint8_t sliceHeight) {
+    if (sliceY == this->preparedY && sliceHeight == this->preparedHeight && this->version == this->preparedVersion) {
+        return;
+    }
+    this->preparedY = sliceY;
+    this->preparedHeight = sliceHeight;
+    this->preparedVersion = this->version;
+
+    // the rows of cells above and below the slice are needed
+    // to interpolate the brightness of its pixels
+    this->cellY = sliceY >> LIGHT_MAP_SHIFT;
+    this->cellRows = ((sliceY + sliceHeight - 1) >> LIGHT_MAP_SHIFT) - this->cellY + 2;
+    memset(this->cells, 0, sizeof(this->cells));
+    // the row sampled last belongs to the previous slice
+    this->rowY = -1;
+
+    int16_t cy0 = this->cellY;
+    int16_t cy1 = this->cellY + this->cellRows - 1;
+
+    for (uint8_t l = 0; l < MAX_LIGHTS; l++) {
+        const Light& light = this->lights[l];
+        if (!light.active || light.intensity == 0) continue;
+
+        // the cells covered by the bounding box of the halo,
+        // clipped to those of the slice
+        int16_t i0 = (light.x - light.radius + CELL_SIZE - 1) >> LIGHT_MAP_SHIFT;
+        int16_t i1 = (light.x + light.radius) >> LIGHT_MAP_SHIFT;
+        int16_t j0 = (light.y - light.radius + CELL_SIZE - 1) >> LIGHT_MAP_SHIFT;
+        int16_t j1 = (light.y + light.radius) >> LIGHT_MAP_SHIFT;
+        if (i0 < 0) i0 = 0;
+        if (i1 > LIGHT_MAP_COLUMNS - 1) i1 = LIGHT_MAP_COLUMNS - 1;
+        if (j0 < cy0) j0 = cy0;
+        if (j1 > cy1) j1 = cy1;
+
+        for (int16_t j = j0; j <= j1; j++) {
+            int16_t dy = (j << LIGHT_MAP_SHIFT) - light.y;
+            uint8_t* cell = this->cells[j - cy0] + i0;
+            for (int16_t i = i0; i <= i1; i++, cell++) {
+                int16_t dx = (i << LIGHT_MAP_SHIFT) - light.x;
+                uint32_t d2 = dx * dx + dy * dy;
+                if (d2 >= light.radius2) continue;
+                // the brightness decreases linearly with the square of the distance,
+                // as for the halo of the tiling: t = 64 * d2 / radius2
+                uint8_t t = (d2 * light.inverse) >> 10;
+                uint16_t lux = *cell + ((light.intensity * (64 - t)) >> 6);
+                // the lights saturate instead of wrapping around
+                *cell = lux > 255 ? 255 : lux;
+            }
+        }
+    }
+}
+
+// the brightness of the pixels is bilinearly interpolated between the cells
+const uint8_t* LightMap::getRow(screen_y_t y, int16_t& xmin, int16_t& xmax) {
+    if (y == this->rowY) {
+        xmin = this->rowMin;
+        xmax = this->rowMax;
+        return this->rowLux;
+    }
+
+    this->rowY = y;
+    this->rowMin = SCREEN_WIDTH;
+    this->rowMax = -1;
+
+    int16_t j = (y >> LIGHT_MAP_SHIFT) - this->cellY;
+    if (j < 0 || j + 1 >= this->cellRows) {
+        // the row does not belong to the slice of the map
+        xmin = this->rowMin;
+        xmax = this->rowMax;
+        return this->rowLux;
+    }
+
+    // vertical interpolation between the two rows of cells
+    // that surround the pixel row (scaled by CELL_SIZE)
+    const uint8_t* upper = this->cells[j];
+    const uint8_t* lower = this->cells[j + 1];
+    uint8_t fy = y & (CELL_SIZE - 1);
+    uint16_t column[LIGHT_MAP_COLUMNS];
+    int16_t first = -1, last = -1;
+    for (uint8_t i = 0; i < LIGHT_MAP_COLUMNS; i++) {
+        column[i] = upper[i] * (CELL_SIZE - fy) + lower[i] * fy;
+        if (column[i]) {
+            if (first < 0) first = i;
+            last = i;
+        }
+    }
+
+    // the row is totally dark
+    if (first < 0) {
+        xmin = this->rowMin;
+        xmax = this->rowMax;
+        return this->rowLux;
+    }
+
+    // the pixels which are lit by the interpolation between
+    // the first and the last lit cells and their neighbours
+    this->rowMin = first ? (first << LIGHT_MAP_SHIFT) - CELL_SIZE + 1 : 0;
+    this->rowMax = (last << LIGHT_MAP_SHIFT) + CELL_SIZE - 1;
+    if (this->rowMax > SCREEN_WIDTH - 1) this->rowMax = SCREEN_WIDTH - 1;
+
+    // horizontal interpolation, then conversion of the light
+    // into a brightness level (0 is the brightest)
+    for (int16_t x = this->rowMin; x <= this->rowMax; x++) {
+        uint8_t i = x >> LIGHT_MAP_SHIFT;
+        uint8_t fx = x & (CELL_SIZE - 1);
+        uint8_t light = (column[i] * (CELL_SIZE - fx) + column[i + 1] * fx) >> (2 * LIGHT_MAP_SHIFT);
+        this->rowLux[x] = DARKEST_LUX - light;
+    }
+
+    xmin = this->rowMin;
+    xmax = this->rowMax;
+    return this->rowLux;
+}
\ No newline at end of file
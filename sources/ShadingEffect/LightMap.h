@@ -0,0 +1,115 @@
+#ifndef SHADING_EFFECT_LIGHT_MAP
+#define SHADING_EFFECT_LIGHT_MAP
+
+#include "Renderable.h"
+#include "Renderer.h"
+#include "constants.h"
+
+// the light map has a reduced resolution: one cell
+// every 2^LIGHT_MAP_SHIFT pixels along each axis
+#define LIGHT_MAP_SHIFT 2
+#define LIGHT_MAP_COLUMNS ((SCREEN_WIDTH >> LIGHT_MAP_SHIFT) + 1)
+// the cells covering the tallest slice, plus one row for the interpolation
+#define LIGHT_MAP_ROWS ((MAX_SLICE_HEIGHT >> LIGHT_MAP_SHIFT) + 2)
+
+// the cells of a row are indexed on 8 bits
+static_assert(LIGHT_MAP_COLUMNS < 256, "the screen is too wide for the light map");
+
+// the brightness levels of the pixels are computed on 8 bits, and only reduced
+// to the levels of the shaded palette by the renderers which sample the map
+#define LUX_BITS 8
+
+// the darkest brightness level
+#define DARKEST_LUX ((1 << LUX_BITS) - 1)
+
+// the maximum number of lights
+#define MAX_LIGHTS 16
+
+// the marker of a free light
+#define NO_LIGHT -1
+
+// a light source, in the coordinates of the screen
+struct Light
+{
+    int16_t x,y;
+    // the radius of the halo, its square, and 2^16 / radius2
+    // so that the falloff is evaluated without any division
+    uint8_t radius;
+    uint16_t radius2;
+    uint16_t inverse;
+    // its brightness in its center (0 to 255)
+    uint8_t intensity;
+    // flag which tells if the light is in use
+    bool active;
+};
+
+// the lighting stage: all the active lights are accumulated (with saturation)
+// in a low-resolution map of the current slice, which the renderers then sample
+// to pick the brightness level of their pixels in the shaded palette...
+// whatever the number of lights, the cost per pixel remains the same
+// > it is subscribed to the `Renderer` so that the rows lit by the lights
+// > which change are redrawn, and the map of each slice is computed once,
+// > by the first renderer which needs it (see `prepare()`)
+class LightMap : public Renderable
+{
+    private:
+
+        Light lights[MAX_LIGHTS];
+
+        // the accumulated light of the cells of the current slice:
+        // the row 0 is the one of the screen row `cellY << LIGHT_MAP_SHIFT`
+        uint8_t cells[LIGHT_MAP_ROWS][LIGHT_MAP_COLUMNS];
+        int16_t cellY;
+        uint8_t cellRows;
+
+        // the slice whose map has been computed, and the version
+        // of the lights it was computed with (bumped at each change)
+        int16_t preparedY;
+        uint8_t preparedHeight;
+        uint16_t preparedVersion;
+        uint16_t version;
+
+        // the brightness levels of the last row sampled, and its lit span
+        uint8_t rowLux[SCREEN_WIDTH];
+        int16_t rowY;
+        int16_t rowMin,rowMax;
+
+        // the range of rows which have changed since the previous frame
+        int16_t changeTop,changeBottom;
+
+        // the rows covered by a light
+        void invalidate(const Light& light);
+
+    public:
+
+        LightMap();
+        ~LightMap();
+
+        // adds a light and returns its handle, or `NO_LIGHT` if there is no room left
+        int8_t add(int16_t x, int16_t y, uint8_t radius, uint8_t intensity);
+        // moves a light
+        void move(int8_t light, int16_t x, int16_t y);
+        // changes the brightness of a light
+        void setIntensity(int8_t light, uint8_t intensity);
+        // removes a light
+        void remove(int8_t light);
+
+        // the rows lit by the lights which have changed since the previous frame
+        void getChanges(int16_t& top, int16_t& bottom) override;
+
+        // accumulates the lights in the map of the slice, unless it's already done
+        void prepare(screen_y_t sliceY, uint8_t sliceHeight);
+
+        // prepares the map of the slice
+        // (the buffer is left untouched)
+        void draw(screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) override;
+        void drawIndexed(screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) override;
+
+        // the brightness levels of the screen row `y` of the current slice,
+        // from 0 (the brightest) to 2^LUX_BITS - 1,
+        // and the span [xmin, xmax] out of which the row is totally dark
+        // (xmin > xmax if the whole row is dark)
+        const uint8_t* getRow(screen_y_t y, int16_t& xmin, int16_t& xmax);
+};
+
+#endif
\ No newline at end of file
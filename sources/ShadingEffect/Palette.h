@@ -0,0 +1,89 @@
+#ifndef SHADING_EFFECT_PALETTE
+#define SHADING_EFFECT_PALETTE
+
+#include <Gamebuino-Meta.h>
+
+// the shaded palette of a spritesheet is computed by the compiler from the
+// reference colors of the spritesheet (see the `img2shading` tool), so that
+// a change in the number of brightness levels or in the falloff curve
+// only requires a rebuild... the layout of the palette is the one
+// the rendering loops expect:
+//   - the transparent color 0xffff in the first entry
+//   - then the 2^LEVELS_POWER_OF_TWO levels of each color, from the brightest
+//     to the darkest, at 1 + (colorIndex << LEVELS_POWER_OF_TWO) + lux
+//   - in RGB565, with the bytes already swapped for the DMA transfers
+
+// the linear falloff of the img4shading tool: the brightness of a level,
+// in 1/256, decreases linearly from 1 (level 0) to 1/levels (the darkest one)
+// > any other curve can be given in the same form
+struct LinearFalloff
+{
+    static constexpr uint16_t brightness(uint16_t level, uint16_t levels) {
+        return (256 * (levels - level)) / levels;
+    }
+};
+
+// the rules to compute each entry of the palette, from the
+// reference colors given in RGB888 (0xrrggbb)
+template <uint8_t LEVELS_POWER_OF_TWO, class Falloff, uint32_t... BASE_COLORS>
+struct PaletteShader
+{
+    static constexpr uint16_t TRANSPARENT = 0xffff;
+    static constexpr uint16_t LEVELS = 1 << LEVELS_POWER_OF_TWO;
+    static constexpr uint16_t SIZE = 1 + sizeof...(BASE_COLORS) * LEVELS;
+    static constexpr uint32_t BASE[sizeof...(BASE_COLORS)] = { BASE_COLORS... };
+
+    // a component of a reference color at a given level, rounded to the nearest
+    static constexpr uint8_t channel(uint32_t color, uint8_t shift, uint16_t level) {
+        return (((color >> shift) & 0xff) * Falloff::brightness(level, LEVELS) + 128) >> 8;
+    }
+
+    static constexpr uint16_t rgb565(uint8_t r, uint8_t g, uint8_t b) {
+        return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+    }
+
+    static constexpr uint16_t swap(uint16_t color) {
+        return (uint16_t)((color << 8) | (color >> 8));
+    }
+
+    static constexpr uint16_t shade(uint32_t color, uint16_t level) {
+        return swap(rgb565(channel(color, 16, level), channel(color, 8, level), channel(color, 0, level)));
+    }
+
+    // the entry `i` of the palette
+    static constexpr uint16_t color(uint16_t i) {
+        return i == 0 ? TRANSPARENT : shade(BASE[(i - 1) >> LEVELS_POWER_OF_TWO], (i - 1) & (LEVELS - 1));
+    }
+};
+
+template <uint8_t LEVELS_POWER_OF_TWO, class Falloff, uint32_t... BASE_COLORS>
+constexpr uint32_t PaletteShader<LEVELS_POWER_OF_TWO, Falloff, BASE_COLORS...>::BASE[sizeof...(BASE_COLORS)];
+
+// the list 0, 1, ..., N - 1 of the entries of the palette
+template <uint16_t... I> struct PaletteEntries {};
+template <uint16_t N, uint16_t... I> struct MakePaletteEntries : MakePaletteEntries<N - 1, N - 1, I...> {};
+template <uint16_t... I> struct MakePaletteEntries<0, I...> { typedef PaletteEntries<I...> type; };
+
+// the palette itself, whose entries are all evaluated at compile time:
+// it therefore stays in the flash memory, exactly as a table written by hand
+template <class Shader, class Entries = typename MakePaletteEntries<Shader::SIZE>::type>
+struct ShadedPalette;
+
+template <class Shader, uint16_t... I>
+struct ShadedPalette<Shader, PaletteEntries<I...>>
+{
+    static const uint16_t COLORMAP[sizeof...(I)];
+
+    // the position of each entry, for the renderers which write the indices
+    // of the colors rather than their codes (see `Renderer::configure()`)
+    // > it only makes sense for a palette of 256 entries at most
+    static const uint8_t INDICES[sizeof...(I)];
+};
+
+template <class Shader, uint16_t... I>
+const uint16_t ShadedPalette<Shader, PaletteEntries<I...>>::COLORMAP[sizeof...(I)] = { Shader::color(I)... };
+
+template <class Shader, uint16_t... I>
+const uint8_t ShadedPalette<Shader, PaletteEntries<I...>>::INDICES[sizeof...(I)] = { (uint8_t)I... };
+
+#endif
\ No newline at end of file
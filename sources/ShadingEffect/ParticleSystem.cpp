@@ -0,0 +1,67 @@
+#include "ParticleSystem.h"
+
+ParticleSystem::ParticleSystem(const Sprite* const* frames, uint8_t frameCount, uint16_t capacity, fixed_t gravity)
+    : SpriteBatch(frames, frameCount, capacity), gravity(gravity), lastFrame(frameCount - 1) {
+    this->pxs = new fixed_t[capacity];
+    this->pys = new fixed_t[capacity];
+    this->vxs = new fixed_t[capacity];
+    this->vys = new fixed_t[capacity];
+    this->lives = new uint8_t[capacity];
+}
+
+ParticleSystem::~ParticleSystem() {
+    delete[] this->pxs;
+    delete[] this->pys;
+    delete[] this->vxs;
+    delete[] this->vys;
+    delete[] this->lives;
+}
+
+bool ParticleSystem::emit(fixed_t x, fixed_t y, fixed_t vx, fixed_t vy, uint8_t life) {
+    if (life == 0) return false;
+    int16_t i = this->add(fixedFloor(x), fixedFloor(y), 0);
+    if (i == -1) return false;
+    this->pxs[i] = x;
+    this->pys[i] = y;
+    this->vxs[i] = vx;
+    this->vys[i] = vy;
+    this->lives[i] = life;
+    return true;
+}
+
+void ParticleSystem::tick() {
+    if (this->count == 0) return;
+
+    uint16_t i = 0;
+    while (i < this->count) {
+        if (--this->lives[i] == 0) {
+            // the last particle takes the place of the dead one,
+            // and is processed in its turn
+            uint16_t last = this->count - 1;
+            this->pxs[i] = this->pxs[last];
+            this->pys[i] = this->pys[last];
+            this->vxs[i] = this->vxs[last];
+            this->vys[i] = this->vys[last];
+            this->lives[i] = this->lives[last];
+            this->xs[i] = this->xs[last];
+            this->ys[i] = this->ys[last];
+            this->frameIndices[i] = this->frameIndices[last];
+            this->count--;
+            continue;
+        }
+
+        this->vys[i] += this->gravity;
+        this->pxs[i] += this->vxs[i];
+        this->pys[i] += this->vys[i];
+        this->xs[i] = fixedFloor(this->pxs[i]);
+        this->ys[i] = fixedFloor(this->pys[i]);
+
+        // the first frame is kept as long as the particle is far from
+        // its death, then it goes through the following ones
+        uint8_t left = this->lives[i] / PARTICLE_STEPS_PER_FRAME;
+        this->frameIndices[i] = left >= this->lastFrame ? 0 : this->lastFrame - left;
+        i++;
+    }
+
+    this->touch();
+}
@@ -0,0 +1,45 @@
+#ifndef SHADING_EFFECT_PARTICLE_SYSTEM
+#define SHADING_EFFECT_PARTICLE_SYSTEM
+
+#include "SpriteBatch.h"
+#include "Fixed.h"
+
+// the number of simulation steps during which a dying particle
+// keeps each of the last frames of the batch
+#define PARTICLE_STEPS_PER_FRAME 2
+
+// a batch of sprites which move by themselves: each particle has a velocity
+// and a lifetime (in simulation steps), in addition to its position and frame
+// > the particles are all updated by `tick()` in a single pass over the arrays,
+// > and take the last frames of the batch as they die out
+class ParticleSystem : public SpriteBatch
+{
+    private:
+
+        // the positions with their fractional part, and the velocities
+        // (in pixels per step), in the same order as the sprites of the batch
+        fixed_t* pxs;
+        fixed_t* pys;
+        fixed_t* vxs;
+        fixed_t* vys;
+        uint8_t* lives;
+
+        // the acceleration added to the vertical velocity at each step
+        fixed_t gravity;
+
+        uint8_t lastFrame;
+
+    public:
+
+        ParticleSystem(const Sprite* const* frames, uint8_t frameCount, uint16_t capacity, fixed_t gravity);
+        ~ParticleSystem();
+
+        // emits a particle at (x,y), which dies after `life` steps
+        bool emit(fixed_t x, fixed_t y, fixed_t vx, fixed_t vy, uint8_t life);
+
+        // a step of the simulation: the particles move, age,
+        // and the dead ones are removed from the batch
+        void tick();
+};
+
+#endif
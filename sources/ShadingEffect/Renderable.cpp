@@ -1,5 +1,29 @@
 #include "Renderable.h"
+#include "constants.h"
 
 // a pure virtual destructor must be defined in an abstract class
 // and in addition, it must be empty if she emulates an interface
-Renderable::~Renderable() = default;
\ No newline at end of file
+Renderable::~Renderable() = default;
+
+// by default, an object spreads over the whole height of the screen
+int16_t Renderable::getTop() {
+    return 0;
+}
+
+int16_t Renderable::getBottom() {
+    return SCREEN_HEIGHT;
+}
+
+// by default, an object is not reentrant
+bool Renderable::isReentrant() {
+    return false;
+}
+
+// by default, an object is not drawn in the indexed mode
+void Renderable::drawIndexed(screen_y_t, uint8_t, uint8_t*) {}
+
+// by default, an object changes all over its extent at each frame
+void Renderable::getChanges(int16_t& top, int16_t& bottom) {
+    top = this->getTop();
+    bottom = this->getBottom();
+}
\ No newline at end of file
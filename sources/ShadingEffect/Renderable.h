@@ -2,6 +2,7 @@
 #define SHADING_EFFECT_RENDERABLE
 
 #include <Gamebuino-Meta.h>
+#include "constants.h"
 
 class Renderable
 {
@@ -11,8 +12,41 @@ class Renderable
         // it will have to be extended in derived classes
         virtual ~Renderable() = 0;
 
+        // the vertical extent of the object on the screen, from the row `getTop()`
+        // (included) to the row `getBottom()` (excluded)... the `Renderer` only
+        // asks the object to draw itself in the slices it overlaps
+        // > by default, the object covers the whole height of the screen
+        virtual int16_t getTop();
+        virtual int16_t getBottom();
+
+        // the vertical range of the screen in which the object has changed
+        // since the previous frame, from `top` (included) to `bottom` (excluded)...
+        // it is queried once per frame by the `Renderer`, which only redraws
+        // the slices that have changed (an empty range means no change)
+        // > by default, the object is considered to change at each frame
+        virtual void getChanges(int16_t& top, int16_t& bottom);
+
+        // tells if `draw()` can be called for several slices at the same time
+        // by several threads (see `RenderBackend`): the object must then only
+        // read its own state while drawing, the state of the frame being
+        // prepared in `getTop()`, `getBottom()` and `getChanges()`
+        // > by default, an object is not reentrant... in the demo, the ball,
+        // > the sprite batches and the tiling lit by its halo are reentrant,
+        // > whereas the light map prepares its cells slice by slice (and so
+        // > does the tiling which samples it)
+        virtual bool isReentrant();
+
         // pure virtual method
-        virtual void draw(uint8_t sliceY, uint8_t sliceHeight, uint16_t* buffer) = 0;
+        // > in the front-to-back mode of the `Renderer`, the object must leave
+        // > untouched the pixels of `Renderer::getCoverage()` which are already
+        // > covered, and cover the opaque pixels it writes
+        virtual void draw(screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) = 0;
+
+        // the rendering in the indexed mode of the `Renderer`: the object writes
+        // the indices of its colors in the screen palette (see `Renderer::setPalette()`),
+        // the brightness level being folded into the index
+        // > by default, the object is not drawn in this mode
+        virtual void drawIndexed(screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer);
 };
 
 #endif
\ No newline at end of file
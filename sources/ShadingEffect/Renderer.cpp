@@ -1,54 +1,161 @@
 #include "Renderer.h"
+#include "Coverage.h"
 
-// definition of the two memory buffers
-uint16_t Renderer::buffer1[SCREEN_WIDTH * SLICE_HEIGHT];
-uint16_t Renderer::buffer2[SCREEN_WIDTH * SLICE_HEIGHT];
+// definition of the memory arena and of its default partition
+uint16_t Renderer::arena[RENDERER_ARENA_SIZE];
+uint8_t Renderer::sliceHeight = DEFAULT_SLICE_HEIGHT;
+uint8_t Renderer::bufferCount = DEFAULT_BUFFER_COUNT;
 
 // no memory forwarding is in progress at the moment
 bool Renderer::drawPending = false;
 
-// the list is empty by default
-Node* Renderer::listeners = NULL;
+// the ring is empty
+uint32_t Renderer::rendered = 0;
+uint32_t Renderer::sent = 0;
+uint8_t Renderer::queuedSlices[MAX_BUFFER_COUNT];
+bool Renderer::asynchronous = true;
+
+// the slices hold color codes by default
+bool Renderer::indexed = false;
+const uint16_t* Renderer::palette = NULL;
+uint8_t Renderer::staging = 0;
+uint8_t Renderer::stagedRows = 0;
+screen_y_t Renderer::stagedY = 0;
+uint8_t Renderer::chunkRow = 0;
+
+// the registry is empty by default
+Renderable* Renderer::listeners[MAX_RENDERABLES];
+int8_t Renderer::depths[MAX_RENDERABLES];
+uint8_t Renderer::listenerCount = 0;
+uint32_t Renderer::sliceMasks[MAX_SLICE_COUNT];
+
+// nothing has been displayed yet, so the first frame must be entirely drawn
+uint32_t Renderer::dirtySlices = 0;
+bool Renderer::invalidated = true;
+
+// the observers are drawn from back to front by default
+bool Renderer::frontToBack = false;
+CoverageMask Renderer::coverage;
+RENDERER_THREAD_LOCAL CoverageMask* Renderer::sliceCoverage = &Renderer::coverage;
+
+// the slices are rendered in the ring of buffers by default
+RenderBackend* Renderer::backend = NULL;
+
+// searches for the position of an observer in the registry
+int8_t Renderer::indexOf(Renderable* renderable) {
+  for (uint8_t i = 0; i < listenerCount; i++) {
+    if (listeners[i] == renderable) return i;
+  }
+  return -1;
+}
 
 // observer subscription
-void Renderer::subscribe(Renderable* renderable) {
-  // if the list is empty, initialize it with the new observer ;-)
-  if (listeners == NULL) {
-    listeners = new Node(renderable);
-  } else {
-    // otherwise the addition is delegated to the following node
-    // since the addition must be done at THE END of the list
-    listeners->add(renderable);
+bool Renderer::subscribe(Renderable* renderable, int8_t depth) {
+  if (listenerCount == MAX_RENDERABLES || indexOf(renderable) != -1) {
+    return false;
   }
+
+  // the observers which are deeper than the new one are shifted
+  // by one position, so that the registry remains sorted...
+  // at equal depth, the new observer is drawn after the previous ones
+  uint8_t i = listenerCount;
+  while (i > 0 && depths[i - 1] > depth) {
+    listeners[i] = listeners[i - 1];
+    depths[i] = depths[i - 1];
+    i--;
+  }
+  listeners[i] = renderable;
+  depths[i] = depth;
+  listenerCount++;
+  invalidated = true;
+
+  return true;
 }
 
 // unsubscribing an observer
 void Renderer::unsubscribe(Renderable* renderable) {
-  // if the list is empty, there's nothing you can do!
-  // on the other hand, if it is not....
-  if (listeners != NULL) {
-    // if the heading node of the list is the one that
-    // encapsulates the observer we're trying to identify
-    if (listeners->getRenderable() == renderable) {
-      // we get the reference to the following node
-      // which will become the new head of the list
-      Node* next = listeners->getNext();
-      // and so we can permanently delete the first node
-      delete listeners;
-      // we hang up the new head of the list
-      listeners = next;
-    } else {
-      // otherwise, the deletion is delegated
-      // to the next node in the list....
-      listeners->del(renderable);
-    }
+  int8_t i = indexOf(renderable);
+  // if the observer has not subscribed, there's nothing you can do!
+  if (i == -1) return;
+  // otherwise the following observers are moved back by one position
+  for (listenerCount--; i < listenerCount; i++) {
+    listeners[i] = listeners[i + 1];
+    depths[i] = depths[i + 1];
   }
+  // what it was covering must be redrawn
+  invalidated = true;
 }
 
 // to know if an object of type `Renderable` is already subscribed
 bool Renderer::hasSubscribed(Renderable* renderable) {
-  // it is enough to identify the node that is the holder of it
-  return listeners->search(renderable) != NULL;
+  return indexOf(renderable) != -1;
+}
+
+// the arena can be shared between a few tall slices or many thin ones...
+// more buffers let the rendering run ahead of the DMA controller
+// and reduce the time spent waiting for it, at the cost of RAM
+// > in the indexed mode, a pixel only takes one byte, but the staging
+// > buffers take a part of the arena
+bool Renderer::configure(uint8_t sliceHeight, uint8_t bufferCount, bool indexed) {
+  if (sliceHeight < MIN_SLICE_HEIGHT || sliceHeight > MAX_SLICE_HEIGHT || bufferCount == 0) {
+    return false;
+  }
+  uint32_t size = (uint32_t)SCREEN_WIDTH * sliceHeight * bufferCount;
+  if (size > (indexed ? INDEXED_ARENA_SIZE : RENDERER_ARENA_SIZE)) {
+    return false;
+  }
+  // the slices still in the ring are sent with the previous partition
+  flush();
+  Renderer::sliceHeight = sliceHeight;
+  Renderer::bufferCount = bufferCount;
+  Renderer::indexed = indexed;
+  invalidated = true;
+  return true;
+}
+
+// forces the whole screen to be redrawn at the next frame
+void Renderer::invalidate() {
+  invalidated = true;
+}
+
+void Renderer::setFrontToBack(bool frontToBack) {
+  Renderer::frontToBack = frontToBack;
+  invalidated = true;
+}
+
+bool Renderer::isFrontToBack() {
+  return frontToBack;
+}
+
+CoverageMask* Renderer::getCoverage() {
+  return frontToBack ? sliceCoverage : NULL;
+}
+
+uint8_t Renderer::getSliceHeight() {
+  return sliceHeight;
+}
+
+uint8_t Renderer::getBufferCount() {
+  return bufferCount;
+}
+
+bool Renderer::isIndexed() {
+  return indexed;
+}
+
+void Renderer::setPalette(const uint16_t* palette) {
+  Renderer::palette = palette;
+  if (indexed) invalidated = true;
+}
+
+// the last slice may be thinner than the others
+uint8_t Renderer::getSliceCount() {
+  return (SCREEN_HEIGHT + sliceHeight - 1) / sliceHeight;
+}
+
+uint8_t Renderer::heightOf(uint8_t sliceIndex) {
+  screen_y_t sliceY = sliceIndex * sliceHeight;
+  return SCREEN_HEIGHT - sliceY < sliceHeight ? SCREEN_HEIGHT - sliceY : sliceHeight;
 }
 
 // the magic routine related to the DMA controller....
@@ -84,38 +191,298 @@ void Renderer::customDrawBuffer(int16_t x, int16_t y, uint16_t* buffer, uint16_t
 void Renderer::waitForPreviousDraw() {
   if (drawPending) {
     // the little magic routine defined above
+    uint32_t start = Telemetry::now();
     Gamebuino_Meta::wait_for_transfers_done();
+    Telemetry::recordWait(start);
     gb.tft.idleMode();
     SPI.endTransaction();
     drawPending = false;
   }
 }
 
+// the transfer is over when all the DMA descriptors are free again
+bool Renderer::isDrawing() {
+  return drawPending && Gamebuino_Meta::dma_desc_free_count < DMA_DESC_COUNT;
+}
+
+// each observer is asked once per frame for its vertical extent,
+// and is recorded in the masks of the slices it overlaps...
+// so the cost only depends on the number of slices actually covered
+// > the slices in which an observer has changed since the previous frame
+// > are recorded in the same way in `dirtySlices`
+void Renderer::cull() {
+  memset(sliceMasks, 0, sizeof(sliceMasks));
+  dirtySlices = 0;
+  for (uint8_t i = 0; i < listenerCount; i++) {
+    int16_t top = listeners[i]->getTop();
+    int16_t bottom = listeners[i]->getBottom();
+    if (top < 0) top = 0;
+    if (bottom > SCREEN_HEIGHT) bottom = SCREEN_HEIGHT;
+    if (top < bottom) {
+      for (uint8_t s = top / sliceHeight; s <= (bottom - 1) / sliceHeight; s++) {
+        sliceMasks[s] |= (uint32_t)1 << i;
+      }
+    }
+
+    listeners[i]->getChanges(top, bottom);
+    if (top < 0) top = 0;
+    if (bottom > SCREEN_HEIGHT) bottom = SCREEN_HEIGHT;
+    if (top < bottom) {
+      for (uint8_t s = top / sliceHeight; s <= (bottom - 1) / sliceHeight; s++) {
+        dirtySlices |= (uint32_t)1 << s;
+      }
+    }
+  }
+
+  // the whole screen must be redrawn after a change in the registry
+  // or in the configuration of the slices
+  if (invalidated) {
+    uint8_t slices = getSliceCount();
+    dirtySlices = slices == 32 ? 0xffffffff : ((uint32_t)1 << slices) - 1;
+    invalidated = false;
+  }
+}
+
+// rendering of a slice in a buffer of the ring
+void Renderer::drawSlice(uint8_t sliceIndex, uint16_t* buffer) {
+  // the ordinate of the first horizontal fringe of the slice is calculated
+  screen_y_t sliceY = sliceIndex * sliceHeight;
+  // as well as its height, since the last slice may be truncated
+  uint8_t height = heightOf(sliceIndex);
+
+  // the notification is only sent to the observers which overlap
+  // the slice, in the order of the registry (from back to front)
+  uint32_t mask = sliceMasks[sliceIndex];
+  if (mask == 0) {
+    // no observer covers this slice, so it remains dark
+    memset(buffer, 0, SCREEN_WIDTH * height * sizeof(uint16_t));
+    return;
+  }
+
+  if (!frontToBack) {
+    while (mask) {
+      uint8_t i = __builtin_ctz(mask);
+      mask &= mask - 1;
+      uint32_t start = Telemetry::now();
+      listeners[i]->draw(sliceY, height, buffer);
+      Telemetry::record(sliceIndex, i, start);
+    }
+    return;
+  }
+
+  // in the front-to-back mode, the observers are notified in the reverse
+  // order of the registry, and the pixels they have covered are tracked
+  sliceCoverage->clear(height);
+  while (mask) {
+    uint8_t i = 31 - __builtin_clz(mask);
+    mask &= ~((uint32_t)1 << i);
+    uint32_t start = Telemetry::now();
+    listeners[i]->draw(sliceY, height, buffer);
+    Telemetry::record(sliceIndex, i, start);
+  }
+
+  // the pixels that no observer has covered remain dark
+  for (uint8_t row = 0; row < height; row++) {
+    int16_t x0 = 0, x1;
+    while (sliceCoverage->nextGap(row, x0, x1)) {
+      memset(buffer + row * SCREEN_WIDTH + x0, 0, (x1 - x0) * sizeof(uint16_t));
+      x0 = x1;
+    }
+  }
+}
+
+// the same rendering, with 8-bit indices
+void Renderer::drawIndexedSlice(uint8_t sliceIndex, uint8_t* buffer) {
+  screen_y_t sliceY = sliceIndex * sliceHeight;
+  uint8_t height = heightOf(sliceIndex);
+
+  uint32_t mask = sliceMasks[sliceIndex];
+  if (mask == 0) {
+    memset(buffer, 0, SCREEN_WIDTH * height);
+    return;
+  }
+
+  if (!frontToBack) {
+    while (mask) {
+      uint8_t i = __builtin_ctz(mask);
+      mask &= mask - 1;
+      uint32_t start = Telemetry::now();
+      listeners[i]->drawIndexed(sliceY, height, buffer);
+      Telemetry::record(sliceIndex, i, start);
+    }
+    return;
+  }
+
+  sliceCoverage->clear(height);
+  while (mask) {
+    uint8_t i = 31 - __builtin_clz(mask);
+    mask &= ~((uint32_t)1 << i);
+    uint32_t start = Telemetry::now();
+    listeners[i]->drawIndexed(sliceY, height, buffer);
+    Telemetry::record(sliceIndex, i, start);
+  }
+
+  for (uint8_t row = 0; row < height; row++) {
+    int16_t x0 = 0, x1;
+    while (sliceCoverage->nextGap(row, x0, x1)) {
+      memset(buffer + row * SCREEN_WIDTH + x0, 0, x1 - x0);
+      x0 = x1;
+    }
+  }
+}
+
+uint16_t* Renderer::bufferAt(uint32_t position) {
+  return arena + (position % bufferCount) * SCREEN_WIDTH * sliceHeight;
+}
+
+// the indexed slices follow the two staging buffers
+uint8_t* Renderer::indexedBufferAt(uint32_t position) {
+  return (uint8_t*)(arena + 2 * STAGING_SIZE) + (position % bufferCount) * SCREEN_WIDTH * sliceHeight;
+}
+
+// the next chunk of the oldest indexed slice of the ring is converted into
+// color codes in the free staging buffer... the slice leaves the ring
+// as soon as its last chunk is expanded
+void Renderer::stage() {
+  if (stagedRows || sent == rendered) return;
+
+  uint8_t sliceIndex = queuedSlices[sent % bufferCount];
+  uint8_t height = heightOf(sliceIndex);
+  uint8_t rows = height - chunkRow < STAGING_ROWS ? height - chunkRow : STAGING_ROWS;
+
+  const uint8_t* in = indexedBufferAt(sent) + chunkRow * SCREEN_WIDTH;
+  uint16_t* out = arena + staging * STAGING_SIZE;
+  // the expansion is unrolled by 8 pixels, the width of the screen being a multiple of 8
+  for (uint16_t n = rows * SCREEN_WIDTH; n; n -= 8, in += 8, out += 8) {
+    out[0] = palette[in[0]];
+    out[1] = palette[in[1]];
+    out[2] = palette[in[2]];
+    out[3] = palette[in[3]];
+    out[4] = palette[in[4]];
+    out[5] = palette[in[5]];
+    out[6] = palette[in[6]];
+    out[7] = palette[in[7]];
+  }
+
+  stagedRows = rows;
+  stagedY = sliceIndex * sliceHeight + chunkRow;
+  chunkRow += rows;
+  if (chunkRow == height) {
+    chunkRow = 0;
+    sent++;
+  }
+}
+
+// the DMA controller cannot notify us of the end of a transfer (its interrupt
+// is handled by the library), so its state is polled: when it is free, the
+// transfer is closed and the oldest slice rendered in the ring is sent
+bool Renderer::poll() {
+  if (indexed) {
+    // in the indexed mode, the next chunk is expanded while the previous one
+    // is being sent... the slices are sent chunk by chunk
+    stage();
+    if (isDrawing()) return true;
+    waitForPreviousDraw();
+    if (stagedRows == 0) return false;
+    uint32_t start = Telemetry::now();
+    customDrawBuffer(0, stagedY, arena + staging * STAGING_SIZE, SCREEN_WIDTH, stagedRows);
+    Telemetry::record(stagedY / sliceHeight, TELEMETRY_SEND, start);
+    staging ^= 1;
+    stagedRows = 0;
+    stage();
+    return true;
+  }
+
+  if (isDrawing()) return true;
+  waitForPreviousDraw();
+  if (sent == rendered) return false;
+
+  uint8_t sliceIndex = queuedSlices[sent % bufferCount];
+  uint32_t start = Telemetry::now();
+  customDrawBuffer(0, sliceIndex * sliceHeight, bufferAt(sent), SCREEN_WIDTH, heightOf(sliceIndex));
+  Telemetry::record(sliceIndex, TELEMETRY_SEND, start);
+  sent++;
+  return true;
+}
+
+void Renderer::flush() {
+  while (poll()) {
+    // the transfers are all that remains to be done
+    if (isDrawing()) waitForPreviousDraw();
+  }
+}
+
+void Renderer::setAsynchronous(bool asynchronous) {
+  if (!asynchronous) flush();
+  Renderer::asynchronous = asynchronous;
+}
+
+bool Renderer::isAsynchronous() {
+  return asynchronous;
+}
+
+void Renderer::setBackend(RenderBackend* backend) {
+  flush();
+  Renderer::backend = backend;
+  invalidated = true;
+}
+
+void Renderer::renderSlice(uint8_t sliceIndex, uint16_t* buffer, CoverageMask* coverage) {
+  sliceCoverage = coverage;
+  drawSlice(sliceIndex, buffer);
+  sliceCoverage = &Renderer::coverage;
+}
+
+bool Renderer::isConcurrent() {
+  for (uint8_t i = 0; i < listenerCount; i++) {
+    if (!listeners[i]->isReentrant()) return false;
+  }
+  return true;
+}
+
 // rendering of the game scene
 void Renderer::draw() {
-  // the number of horizontal slices to be cut is calculated
-  uint8_t slices = SCREEN_HEIGHT / SLICE_HEIGHT;
-  // then we go through each slice one by one
-  for (uint8_t sliceIndex = 0; sliceIndex < slices; sliceIndex++) {
-
-    // we define a pointer that will alternate between the two memory buffers
-    uint16_t* buffer = sliceIndex % 2 == 0 ? buffer1 : buffer2;
-    // the ordinate of the first horizontal fringe of the slice is calculated
-    uint8_t sliceY = sliceIndex * SLICE_HEIGHT;
-
-    // the notification is sent to the heading node
-    // which in turn will relay it to the next node,
-    // and so on, until the end of the list
-    listeners->draw(sliceY, SLICE_HEIGHT, buffer);
-  
-    // then we make sure that sending the previous buffer
-    // to the DMA controller has taken place
-    if (sliceIndex != 0) waitForPreviousDraw();
-    // after which you can then send the current buffer
-    customDrawBuffer(0, sliceY, buffer, SCREEN_WIDTH, SLICE_HEIGHT);
-  }
-
-  // always wait until the DMA transfer is completed
-  // for the last slice before leaving the method!
-  waitForPreviousDraw();
+  Telemetry::beginFrame();
+
+  // the slices overlapped by each observer are determined,
+  // as well as the slices which have changed since the previous frame
+  cull();
+
+  // the backend renders and sends the slices by itself
+  if (backend && !indexed) {
+    backend->drawSlices(dirtySlices);
+    return;
+  }
+
+  // only the slices which have changed are rendered and sent to the display,
+  // the other ones are left as they are on the screen
+  for (uint32_t mask = dirtySlices; mask; mask &= mask - 1) {
+    // a new slice can be rendered as soon as a buffer of the ring is free,
+    // knowing that the slices rendered but not yet sent occupy a buffer
+    // (some of them may remain from the previous frame), as well as
+    // the one that the DMA controller may still be reading (in the indexed mode,
+    // the controller reads the staging buffers instead)
+    while (rendered - sent + (!indexed && drawPending) >= bufferCount) {
+      if (!poll()) break;
+      // all we can do is wait for the end of the transfer
+      if (rendered - sent + (!indexed && drawPending) >= bufferCount) waitForPreviousDraw();
+    }
+
+    uint8_t sliceIndex = __builtin_ctz(mask);
+    if (indexed) {
+      drawIndexedSlice(sliceIndex, indexedBufferAt(rendered));
+    } else {
+      drawSlice(sliceIndex, bufferAt(rendered));
+    }
+    queuedSlices[rendered % bufferCount] = sliceIndex;
+    rendered++;
+
+    // the oldest rendered slice is sent as soon as the DMA controller is available
+    poll();
+  }
+
+  // in the synchronous mode, we wait until the DMA transfer is completed
+  // for the last slice before leaving the method... in the asynchronous one,
+  // the remaining slices are sent by the next calls to `poll()`
+  if (!asynchronous) flush();
 }
\ No newline at end of file
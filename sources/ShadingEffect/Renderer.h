@@ -2,45 +2,238 @@
 #define SHADING_EFFECT_RENDERER
 
 #include <Gamebuino-Meta.h>
-#include "Node.h"
 #include "Renderable.h"
+#include "Telemetry.h"
 #include "constants.h"
 
-// definition of the slices height
-#define SLICE_HEIGHT 8
+// the thinnest slices that can be configured...
+// there are then at most 32 slices, which fit in a 32-bit mask
+// > 4 rows on the screen of the console, more on the taller panels
+#define MIN_SLICE_HEIGHT ((SCREEN_HEIGHT + 31) / 32 > 4 ? (SCREEN_HEIGHT + 31) / 32 : 4)
+
+// the number of slices of the thinnest partition of the screen... the last
+// slice is shorter when `MIN_SLICE_HEIGHT` does not divide the height
+#define MAX_SLICE_COUNT ((SCREEN_HEIGHT + MIN_SLICE_HEIGHT - 1) / MIN_SLICE_HEIGHT)
+
+// the default height of the slices and number of buffers
+#define DEFAULT_SLICE_HEIGHT (MIN_SLICE_HEIGHT > 8 ? MIN_SLICE_HEIGHT : 8)
+#define DEFAULT_BUFFER_COUNT 2
+
+// the memory arena in which the slice buffers are carved (in pixels)...
+// by default, it holds two slices of the default height
+#define RENDERER_ARENA_SIZE (SCREEN_WIDTH * DEFAULT_SLICE_HEIGHT * DEFAULT_BUFFER_COUNT)
+
+// in the indexed mode, the slices hold 8-bit indices in the screen palette,
+// which are expanded into RGB565 by chunks of `STAGING_ROWS` rows just before
+// being sent to the DMA controller: the two staging buffers of the chunks
+// (one being expanded while the other one is sent) are carved at the
+// beginning of the arena, and the slices share the rest of it
+#define STAGING_ROWS 2
+#define STAGING_SIZE (SCREEN_WIDTH * STAGING_ROWS)
+
+// the size of the arena left to the indexed slices, in bytes
+#define INDEXED_ARENA_SIZE (2 * (RENDERER_ARENA_SIZE - 2 * STAGING_SIZE))
+
+// the tallest slice and the largest ring of buffers that can be configured,
+// whatever the mode
+#define MAX_SLICE_HEIGHT (INDEXED_ARENA_SIZE / SCREEN_WIDTH)
+#define MAX_BUFFER_COUNT (INDEXED_ARENA_SIZE / (SCREEN_WIDTH * MIN_SLICE_HEIGHT))
+
+// the height of the slices is held on 8 bits
+static_assert(MAX_SLICE_HEIGHT < 256, "the screen is too tall");
+static_assert(MAX_SLICE_COUNT <= 32, "the slices must fit in a 32-bit mask");
+
+// the number of entries of the screen palette of the indexed mode
+#define SCREEN_PALETTE_SIZE 256
+
+// the host build may render several slices at the same time (see `RenderBackend`):
+// the state of the slice being drawn is then specific to each thread
+#if RENDERER_THREADS
+#define RENDERER_THREAD_LOCAL thread_local
+#else
+#define RENDERER_THREAD_LOCAL
+#endif
+
+// the maximum number of observers that can subscribe to the renderer
+// > it must not exceed 32, since the observers overlapping
+// > each slice are recorded in a 32-bit mask
+#define MAX_RENDERABLES 16
+
+class CoverageMask;
+
+// a backend which renders the slices of the frame in its own way, in place
+// of the ring of buffers of the `Renderer` (the host build spreads them over
+// several threads, see `host/ParallelRenderer.h`)... it is given the mask of
+// the slices to redraw, and renders them with `Renderer::renderSlice()`
+class RenderBackend
+{
+    public:
+
+        virtual ~RenderBackend() {}
+        virtual void drawSlices(uint32_t dirtySlices) = 0;
+};
 
 class Renderer
 {
     private:
     
-        // declaration of the two memory buffers in which
-        // will be performed the rendering calculations
-        static uint16_t buffer1[SCREEN_WIDTH * SLICE_HEIGHT];
-        static uint16_t buffer2[SCREEN_WIDTH * SLICE_HEIGHT];
+        // declaration of the memory arena in which the ring of
+        // slice buffers is carved: the rendering calculations of the
+        // slice `n` are performed in the buffer `n % bufferCount`
+        static uint16_t arena[RENDERER_ARENA_SIZE];
+        static uint8_t sliceHeight;
+        static uint8_t bufferCount;
         // flag which will tell us if a memory forwarding
         // to the DMA controller is in progress or not
         static bool drawPending;
 
-        // pointer to the list of observers
-        static Node* listeners;
+        // the slices rendered in the ring are sent to the display in order:
+        // `rendered` and `sent` count the slices since the beginning (they may wrap
+        // around), and the slice rendered at the position `p` is held in the
+        // buffer `p % bufferCount`, its index being in `queuedSlices`
+        static uint32_t rendered;
+        static uint32_t sent;
+        static uint8_t queuedSlices[MAX_BUFFER_COUNT];
+        // flag which tells if `draw()` returns before the last slices are sent
+        static bool asynchronous;
+
+        // flag which tells if the slices are rendered with 8-bit indices,
+        // the palette which converts them into color codes, and the chunk
+        // of the slice `sent` which has been expanded in the staging buffer
+        // `staging` and is waiting to be sent (if `stagedRows` is not zero),
+        // the next one beginning at the row `chunkRow` of the slice
+        static bool indexed;
+        static const uint16_t* palette;
+        static uint8_t staging;
+        static uint8_t stagedRows;
+        static screen_y_t stagedY;
+        static uint8_t chunkRow;
+
+        // the observers are stored contiguously, sorted by increasing depth:
+        // the ones with the lowest depth are drawn first (in the background)
+        static Renderable* listeners[MAX_RENDERABLES];
+        static int8_t depths[MAX_RENDERABLES];
+        static uint8_t listenerCount;
+
+        // for each slice, the mask of the observers that overlap it
+        // (bit `i` stands for `listeners[i]`)
+        static uint32_t sliceMasks[MAX_SLICE_COUNT];
+
+        // the mask of the slices which have changed since the previous frame
+        // (bit `n` stands for the slice `n`)... `MIN_SLICE_HEIGHT` ensures
+        // that there are no more than 32 slices
+        static uint32_t dirtySlices;
+        // flag which forces the whole screen to be redrawn
+        static bool invalidated;
+
+        // flag which tells if the observers are drawn from front to back,
+        // and the pixels of the current slice they have already covered
+        static bool frontToBack;
+        static CoverageMask coverage;
+        // the coverage mask of the slice being drawn by the current thread
+        static RENDERER_THREAD_LOCAL CoverageMask* sliceCoverage;
+
+        // the backend which renders the slices, if any
+        static RenderBackend* backend;
+
+        // returns the position of an observer in `listeners`, or -1
+        static int8_t indexOf(Renderable* renderable);
+        // records in `sliceMasks` the slices overlapped by each observer
+        static void cull();
 
         // method to initiate memory forwarding to the DMA controller
         static void customDrawBuffer(int16_t x, int16_t y, uint16_t* buffer, uint16_t w, uint16_t h);
         // method for waiting for the transfer to be completed
         // and close the transaction with the DMA controller
         static void waitForPreviousDraw();
+        // allows to know if the DMA controller is still busy
+        static bool isDrawing();
+        // performs the rendering of a slice in a buffer of the ring
+        static void drawSlice(uint8_t sliceIndex, uint16_t* buffer);
+        static void drawIndexedSlice(uint8_t sliceIndex, uint8_t* buffer);
+        // the buffer of the ring at a given position
+        static uint16_t* bufferAt(uint32_t position);
+        static uint8_t* indexedBufferAt(uint32_t position);
+        // the height of a slice, since the last one may be truncated
+        static uint8_t heightOf(uint8_t sliceIndex);
+        // expands the next chunk of the indexed slices into a staging buffer
+        static void stage();
     
     public:
 
-        // observer subscription
-        static void subscribe(Renderable* renderable);
+        // observer subscription at a given depth...
+        // returns false if the renderer is full or if the observer is already subscribed
+        static bool subscribe(Renderable* renderable, int8_t depth = 0);
         // unsubscribing an observer
         static void unsubscribe(Renderable* renderable);
         // allows to know if an object of type `Renderable` is already subscribed
         static bool hasSubscribed(Renderable* renderable);
 
-        // performs rendering of the game scene
+        // sets the height of the slices and the number of buffers in the ring,
+        // and if the slices hold 8-bit indices (they then take half as much memory,
+        // so the slices can be taller or more numerous)... returns false
+        // (and keeps the current setting) if the buffers do not fit in the arena
+        static bool configure(uint8_t sliceHeight, uint8_t bufferCount, bool indexed = false);
+        static uint8_t getSliceHeight();
+        static uint8_t getBufferCount();
+        static uint8_t getSliceCount();
+        static bool isIndexed();
+
+        // the `SCREEN_PALETTE_SIZE` color codes (byte-swapped RGB565) of the indices
+        // written by the observers in the indexed mode (see `Renderable::drawIndexed()`)
+        static void setPalette(const uint16_t* palette);
+
+        // forces the whole screen to be redrawn at the next frame
+        static void invalidate();
+
+        // by default, the observers are drawn from back to front and the nearest
+        // ones overwrite the farthest (the painter's algorithm)... in the front-to-back
+        // mode, they are drawn from the nearest to the farthest instead: each one
+        // only writes the pixels that are not covered yet, and covers those it writes
+        // (see `getCoverage()`), so that each pixel is written only once
+        static void setFrontToBack(bool frontToBack);
+        static bool isFrontToBack();
+
+        // the coverage mask of the slice being drawn in the front-to-back mode,
+        // or NULL in the painter's mode (the observers then draw all their pixels)
+        static CoverageMask* getCoverage();
+
+        // performs rendering of the game scene...
+        // only the slices in which an observer has changed are redrawn
         static void draw();
+
+        // the slices of the following frames are rendered by the given backend
+        // (NULL restores the ring of buffers)... the indexed mode
+        // always uses the ring of buffers
+        static void setBackend(RenderBackend* backend);
+
+        // renders a slice in a buffer of `SCREEN_WIDTH * getSliceHeight()` pixels
+        // provided by a backend, with its own coverage mask for the front-to-back
+        // mode... several slices can be rendered at the same time by several
+        // threads as long as `isConcurrent()` returns true
+        static void renderSlice(uint8_t sliceIndex, uint16_t* buffer, CoverageMask* coverage);
+
+        // true if all the observers can be drawn in several slices at the same
+        // time (see `Renderable::isReentrant()`)
+        static bool isConcurrent();
+
+        // in the asynchronous mode (the default one), `draw()` returns as soon as
+        // the last slice is rendered, while the last slices of the ring are still
+        // waiting to be sent to the display: the game logic of the next frame can
+        // then run during their transfers, instead of waiting for them
+        static void setAsynchronous(bool asynchronous);
+        static bool isAsynchronous();
+
+        // sends the next slice of the ring as soon as the DMA controller is free...
+        // the game engine calls it between two steps of the simulation so as not
+        // to leave the display idle, and it returns false when all the slices
+        // have been sent (the SPI transaction may still be open: `flush()` must
+        // be called before the buttons or another device of the bus are read)
+        static bool poll();
+
+        // waits until all the slices of the ring have been sent, and the SPI bus
+        // released (before using another device of the bus, such as the SD card)
+        static void flush();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,5 @@
+#include "ScreenPalette.h"
+
+// the colors of the sprites are referenced by `ScreenShader::color()`
+constexpr uint16_t ScreenShader::BALL_COLORS[BALL_COLOR_COUNT];
+constexpr uint16_t ScreenShader::SPARKS_COLORS[SPARKS_COLOR_COUNT];
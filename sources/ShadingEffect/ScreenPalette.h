@@ -0,0 +1,42 @@
+#ifndef SHADING_EFFECT_SCREEN_PALETTE
+#define SHADING_EFFECT_SCREEN_PALETTE
+
+#include "Palette.h"
+#include "Renderer.h"
+#include "Tiling.h"
+
+// the screen palette of the indexed mode of the `Renderer`, which gathers
+// the colors of all the observers of the demo (byte-swapped RGB565):
+//   - the shaded palette of the default tileset, at the same positions as
+//     in its own `COLORMAP`, except its transparent entry 0 which is never
+//     drawn by the tiling: it stands for the black of the dark pixels
+//   - then the colors of the ball and those of the sparks
+// > the observers write these positions directly in the indexed slices
+#define TILES_COLOR_INDEX 0
+#define BALL_COLOR_INDEX (TILES_COLOR_INDEX + DefaultTileset::Shader::SIZE)
+#define BALL_COLOR_COUNT 5
+#define SPARKS_COLOR_INDEX (BALL_COLOR_INDEX + BALL_COLOR_COUNT)
+#define SPARKS_COLOR_COUNT 3
+
+struct ScreenShader
+{
+    static constexpr uint16_t SIZE = SCREEN_PALETTE_SIZE;
+    static constexpr uint16_t BALL_COLORS[BALL_COLOR_COUNT] = { 0x0ef8, 0x5cfe, 0x0780, 0x0450, 0x0000 };
+    static constexpr uint16_t SPARKS_COLORS[SPARKS_COLOR_COUNT] = { 0x20fd, 0xe0ff, 0x00f8 };
+
+    // the entry `i` of the palette (the unused entries are black)
+    static constexpr uint16_t color(uint16_t i) {
+        return i == TILES_COLOR_INDEX ? 0x0000
+            : i < BALL_COLOR_INDEX ? DefaultTileset::Shader::color(i - TILES_COLOR_INDEX)
+            : i < SPARKS_COLOR_INDEX ? BALL_COLORS[i - BALL_COLOR_INDEX]
+            : i < SPARKS_COLOR_INDEX + SPARKS_COLOR_COUNT ? SPARKS_COLORS[i - SPARKS_COLOR_INDEX]
+            : 0x0000;
+    }
+};
+
+static_assert(SPARKS_COLOR_INDEX + SPARKS_COLOR_COUNT <= SCREEN_PALETTE_SIZE, "the screen palette is full");
+
+// the palette itself is evaluated by the compiler and stays in the flash memory
+typedef ShadedPalette<ScreenShader> ScreenPalette;
+
+#endif
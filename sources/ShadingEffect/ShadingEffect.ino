@@ -1,5 +1,8 @@
 #include <Gamebuino-Meta.h>
 #include "GameEngine.h"
+#include "Renderer.h"
+#include "Telemetry.h"
+#include "InputTrace.h"
 
 void setup() {
     gb.begin();
@@ -13,6 +16,7 @@ void setup() {
     gb.display.init(0, 0, ColorMode::rgb565);
 
     // maximum frame rate to reach 100% of CPU loading
+    // (the simulation keeps its own pace, see `SIMULATION_STEP_US`)
     // gb.setFrameRate(32);
 
     // initialization of the main controller
@@ -20,13 +24,27 @@ void setup() {
 }
 
 void loop() {
+    // the buttons are read through the same SPI bus as the display, so the
+    // slices the renderer has not been able to send yet are sent, and the
+    // bus released, before waiting for the next frame
+    Renderer::flush();
     while(!gb.update());
 
+    #if TELEMETRY_ENABLED
+    // the serial port is reserved for the binary stream of the telemetry
+    Telemetry::flush();
+    #elif INPUT_TRACE_ENABLED
+    // the serial port is reserved for the input trace
+    InputTrace::sample();
+    #else
     // measure the CPU load every second (we are at 25 fps by default)
     // and send the data to the serial port
     if (gb.frameCount % 25 == 0) {
-        SerialUSB.printf("CPU: %i, RAM: %i\n", gb.getCpuLoad(), gb.getFreeRam());
+        const FrameStats& stats = GameEngine::getStats();
+        SerialUSB.printf("CPU: %i, RAM: %i, frame: %lu us (max %lu), dropped: %lu\n",
+            gb.getCpuLoad(), gb.getFreeRam(), stats.meanFrameUs, stats.maxFrameUs, stats.dropped);
     }
+    #endif
 
     // delegates the main control loop
     GameEngine::tick();
@@ -0,0 +1,12 @@
+#include "ShadingKernels.h"
+
+// the tilings use their reference loop by default
+ShadingKernels* ShadingKernels::installed = NULL;
+
+void ShadingKernels::install(ShadingKernels* kernels) {
+    installed = kernels;
+}
+
+ShadingKernels* ShadingKernels::getInstalled() {
+    return installed;
+}
@@ -0,0 +1,57 @@
+#ifndef SHADING_EFFECT_SHADING_KERNELS
+#define SHADING_EFFECT_SHADING_KERNELS
+
+#include <Gamebuino-Meta.h>
+
+// the shaded ramps of a tileset and the reduction of its brightness levels,
+// laid out for the shading kernels: the ramps are split into planes of bytes,
+// so that a kernel can look up 16 entries at a time in each of them... the byte `b`
+// of the entry `level` of the ramp of the color index `c` is found at
+// `planes[((c * bytes + b) << levelsPowerOfTwo) + level]`, with `bytes`
+// the size of a pixel (2 for the color codes, 1 for the indices)
+struct ShadingTables
+{
+    const uint8_t* planes;
+    uint8_t colorCount;
+    uint8_t levelsPowerOfTwo;
+    // the shift from the brightness levels on `LUX_BITS` to those of the tileset
+    uint8_t luxShift;
+};
+
+// the kernels of the shading of the tiling, which the host build replaces
+// with vectorized versions chosen according to the features of its CPU
+// (see `host/VectorKernels.h`)... when they are installed, the lit pixels
+// of each gap of a row are shaded in a single call over the whole gap,
+// instead of one run of pixels per tile column:
+//   - the pixel `i` has the color index `colors[i]` and the brightness `lux[i]`
+//     (read from the light map, or from the halo which is then precomputed
+//     for the whole screen)
+//   - the Bayer threshold `thresholds[(phase + i) & 3]` is added to its brightness,
+//     which is reduced to a level of the tileset exactly as in `Tiling.h`
+//   - and the pixel takes the entry of this level in the ramp of its color
+// > the kernels must give exactly the same pixels as the rendering loop of
+// > `Tiling.h`, which remains the reference, and the only one of the console:
+// > they are only used in the builds which define `SHADING_KERNELS`
+class ShadingKernels
+{
+    private:
+
+        static ShadingKernels* installed;
+
+    public:
+
+        virtual ~ShadingKernels() {}
+
+        // the name of the kernels, for the benchmarks
+        virtual const char* getName() = 0;
+
+        // the shading of `count` pixels, into color codes or into indices of the screen palette
+        virtual void shade(uint16_t* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) = 0;
+        virtual void shade(uint8_t* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) = 0;
+
+        // the kernels used by the tilings, or NULL for the reference loop
+        static void install(ShadingKernels* kernels);
+        static ShadingKernels* getInstalled();
+};
+
+#endif
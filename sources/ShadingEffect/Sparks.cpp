@@ -0,0 +1,78 @@
+#include "Sparks.h"
+#include "ScreenPalette.h"
+
+// the initial speed of the sparks, in pixels per step,
+// and the gravity which makes them fall back
+#define SPARK_SPEED FIXED(2.5)
+#define SPARK_GRAVITY FIXED(0.25)
+
+// the three frames of a spark: a small cross, a square, then a single pixel
+//   yellow 0xffe0, orange 0xfd20 and red 0xf800 (byte-swapped, as in `Ball`)
+const uint16_t Sparks::FRAME_ROWS[3][4] = {
+    { 0, 1, 2, 3 },
+    { 3, 4, 5, 5 },
+    { 5, 6, 6, 6 }
+};
+
+const SpriteSpan Sparks::FRAME_SPANS[] = {
+    // the cross (3x3)
+    { 1, 1, 0 }, { 0, 3, 1 }, { 1, 1, 4 },
+    // the square (2x2)
+    { 0, 2, 5 }, { 0, 2, 7 },
+    // the pixel
+    { 0, 1, 9 }
+};
+
+const uint16_t Sparks::FRAME_PIXELS[] = {
+    0x20fd, 0x20fd, 0xe0ff, 0x20fd, 0x20fd,
+    0x20fd, 0x20fd, 0x20fd, 0x20fd,
+    0x00f8
+};
+
+// and their indices in the screen palette of the indexed mode
+#define ORANGE (SPARKS_COLOR_INDEX + 0)
+#define YELLOW (SPARKS_COLOR_INDEX + 1)
+#define RED (SPARKS_COLOR_INDEX + 2)
+const uint8_t Sparks::FRAME_INDICES[] = {
+    ORANGE, ORANGE, YELLOW, ORANGE, ORANGE,
+    ORANGE, ORANGE, ORANGE, ORANGE,
+    RED
+};
+
+// the rows of each frame index the spans of all the frames
+const Sprite Sparks::FRAMES[] = {
+    { 3, 3, FRAME_ROWS[0], FRAME_SPANS, FRAME_PIXELS, FRAME_INDICES },
+    { 2, 2, FRAME_ROWS[1], FRAME_SPANS, FRAME_PIXELS, FRAME_INDICES },
+    { 1, 1, FRAME_ROWS[2], FRAME_SPANS, FRAME_PIXELS, FRAME_INDICES }
+};
+
+const Sprite* const Sparks::FRAME_POINTERS[] = { &FRAMES[0], &FRAMES[1], &FRAMES[2] };
+
+// the unit vectors every 22.5 degrees, starting upwards
+const fixed_t Sparks::DIRECTIONS[SPARKS_PER_BURST][2] = {
+    { FIXED( 0.0000), FIXED(-1.0000) }, { FIXED( 0.3827), FIXED(-0.9239) },
+    { FIXED( 0.7071), FIXED(-0.7071) }, { FIXED( 0.9239), FIXED(-0.3827) },
+    { FIXED( 1.0000), FIXED( 0.0000) }, { FIXED( 0.9239), FIXED( 0.3827) },
+    { FIXED( 0.7071), FIXED( 0.7071) }, { FIXED( 0.3827), FIXED( 0.9239) },
+    { FIXED( 0.0000), FIXED( 1.0000) }, { FIXED(-0.3827), FIXED( 0.9239) },
+    { FIXED(-0.7071), FIXED( 0.7071) }, { FIXED(-0.9239), FIXED( 0.3827) },
+    { FIXED(-1.0000), FIXED( 0.0000) }, { FIXED(-0.9239), FIXED(-0.3827) },
+    { FIXED(-0.7071), FIXED(-0.7071) }, { FIXED(-0.3827), FIXED(-0.9239) }
+};
+
+Sparks::Sparks(uint16_t capacity) : ParticleSystem(FRAME_POINTERS, 3, capacity, SPARK_GRAVITY) {}
+
+Sparks::~Sparks() {}
+
+void Sparks::burst(int16_t x, int16_t y) {
+    for (uint8_t k = 0; k < SPARKS_PER_BURST; k++) {
+        // the sparks do not all last as long, so that the burst does not look too regular
+        this->emit(
+            (fixed_t)x << FIXED_SHIFT,
+            (fixed_t)y << FIXED_SHIFT,
+            fixedMul(DIRECTIONS[k][0], SPARK_SPEED),
+            fixedMul(DIRECTIONS[k][1], SPARK_SPEED),
+            12 + (k * 5) % 8
+        );
+    }
+}
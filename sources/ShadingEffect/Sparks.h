@@ -0,0 +1,39 @@
+#ifndef SHADING_EFFECT_SPARKS
+#define SHADING_EFFECT_SPARKS
+
+#include "ParticleSystem.h"
+
+// the maximum number of sparks on the screen at the same time
+#define SPARKS_CAPACITY 64
+
+// the number of sparks thrown by each burst
+#define SPARKS_PER_BURST 16
+
+// the sparks thrown by the ball, which fall back under the effect
+// of gravity as they die out
+class Sparks : public ParticleSystem
+{
+    private:
+
+        // the frames of a spark, from the brightest to the dimmest,
+        // compiled into runs of opaque pixels
+        static const uint16_t FRAME_ROWS[3][4];
+        static const SpriteSpan FRAME_SPANS[];
+        static const uint16_t FRAME_PIXELS[];
+        static const uint8_t FRAME_INDICES[];
+        static const Sprite FRAMES[];
+        static const Sprite* const FRAME_POINTERS[];
+
+        // the directions in which the sparks of a burst are thrown
+        static const fixed_t DIRECTIONS[SPARKS_PER_BURST][2];
+
+    public:
+
+        Sparks(uint16_t capacity = SPARKS_CAPACITY);
+        ~Sparks();
+
+        // throws a burst of sparks around the point (x,y) of the screen
+        void burst(int16_t x, int16_t y);
+};
+
+#endif
@@ -0,0 +1,60 @@
+#include "Sprite.h"
+#include "Renderer.h"
+#include "Coverage.h"
+#include "constants.h"
+
+// the spans are copied in the same way whatever the type of the pixels:
+// color codes, or indices in the screen palette
+template <typename Pixel>
+static void drawSpans(const Sprite& sprite, const Pixel* spritePixels, int16_t x, int16_t y, screen_y_t sliceY, uint8_t sliceHeight, Pixel* buffer) {
+    // the portion of the sprite which is located within
+    // the current slice is determined along the Y axis
+    int16_t first = sliceY - y;
+    int16_t last = sliceY + sliceHeight - y;
+    if (first < 0) first = 0;
+    if (last > sprite.height) last = sprite.height;
+
+    // in the front-to-back mode, the pixels already covered
+    // by a nearer renderable are left untouched
+    CoverageMask* coverage = Renderer::getCoverage();
+
+    for (int16_t row = first; row < last; row++) {
+        // the row of the slice where this row of the sprite is drawn
+        Pixel* out = buffer + (y + row - sliceY) * SCREEN_WIDTH;
+
+        // each run of opaque pixels is copied in one go...
+        // it is only clipped if it overflows the edges of the screen
+        for (uint16_t s = sprite.rows[row]; s < sprite.rows[row + 1]; s++) {
+            const SpriteSpan& span = sprite.spans[s];
+            const Pixel* pixels = spritePixels + span.pixel;
+            int16_t from = x + span.x;
+            int16_t to = from + span.length;
+            if (from < 0) {
+                pixels -= from;
+                from = 0;
+            }
+            if (to > SCREEN_WIDTH) to = SCREEN_WIDTH;
+            if (from >= to) continue;
+            if (!coverage) {
+                memcpy(out + from, pixels, (to - from) * sizeof(Pixel));
+                continue;
+            }
+
+            // only the gaps of the span are copied, then the whole span is covered
+            int16_t x0 = from, x1;
+            while (coverage->nextGap(y + row - sliceY, x0, x1, to)) {
+                memcpy(out + x0, pixels + x0 - from, (x1 - x0) * sizeof(Pixel));
+                x0 = x1;
+            }
+            coverage->cover(y + row - sliceY, from, to);
+        }
+    }
+}
+
+void Sprite::draw(int16_t x, int16_t y, screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) const {
+    drawSpans(*this, this->pixels, x, y, sliceY, sliceHeight, buffer);
+}
+
+void Sprite::drawIndexed(int16_t x, int16_t y, screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) const {
+    drawSpans(*this, this->indices, x, y, sliceY, sliceHeight, buffer);
+}
@@ -0,0 +1,42 @@
+#ifndef SHADING_EFFECT_SPRITE
+#define SHADING_EFFECT_SPRITE
+
+#include <Gamebuino-Meta.h>
+#include "constants.h"
+
+// a run of opaque pixels in a row of a sprite
+struct SpriteSpan
+{
+    // the abscissa of the first pixel of the run in the row
+    uint8_t x;
+    // the number of pixels in the run
+    uint8_t length;
+    // the index of the first pixel of the run in `Sprite::pixels`
+    uint16_t pixel;
+};
+
+// a sprite "compiled" into runs of opaque pixels by the `sprite2spans` tool:
+// the transparent pixels are no longer stored at all, so that the sprite can be
+// copied into the slices span by span, without testing the transparency of each pixel
+// > it's an aggregate, so that the compiler can leave it in flash memory
+struct Sprite
+{
+    uint8_t width;
+    uint8_t height;
+    // for each row, the index of its first span in `spans`
+    // (`rows[height]` is the total number of spans)
+    const uint16_t* rows;
+    // the runs of opaque pixels, row after row
+    const SpriteSpan* spans;
+    // the color codes of the opaque pixels only
+    const uint16_t* pixels;
+    // and their indices in the screen palette, for the indexed mode of the `Renderer`
+    const uint8_t* indices;
+
+    // draws the part of the sprite located at (x,y) on the screen
+    // which overlaps the current slice
+    void draw(int16_t x, int16_t y, screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) const;
+    void drawIndexed(int16_t x, int16_t y, screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "SpriteBatch.h"
+
+SpriteBatch::SpriteBatch(const Sprite* const* frames, uint8_t frameCount, uint16_t capacity)
+    : frames(frames), frameCount(frameCount), reach(0), sortedSliceHeight(0), sorted(false),
+      top(SCREEN_HEIGHT), bottom(0), drawnTop(SCREEN_HEIGHT), drawnBottom(0), changed(false),
+      capacity(capacity), count(0) {
+    this->order = new uint16_t[capacity];
+    this->xs = new int16_t[capacity];
+    this->ys = new int16_t[capacity];
+    this->frameIndices = new uint8_t[capacity];
+}
+
+SpriteBatch::~SpriteBatch() {
+    delete[] this->order;
+    delete[] this->xs;
+    delete[] this->ys;
+    delete[] this->frameIndices;
+}
+
+void SpriteBatch::touch() {
+    this->sorted = false;
+    this->changed = true;
+}
+
+int16_t SpriteBatch::add(int16_t x, int16_t y, uint8_t frame) {
+    if (this->count == this->capacity) return -1;
+    uint16_t i = this->count++;
+    this->xs[i] = x;
+    this->ys[i] = y;
+    this->frameIndices[i] = frame < this->frameCount ? frame : this->frameCount - 1;
+    this->touch();
+    return i;
+}
+
+void SpriteBatch::remove(uint16_t index) {
+    if (index >= this->count) return;
+    uint16_t last = --this->count;
+    this->xs[index] = this->xs[last];
+    this->ys[index] = this->ys[last];
+    this->frameIndices[index] = this->frameIndices[last];
+    this->touch();
+}
+
+void SpriteBatch::clear() {
+    this->count = 0;
+    this->touch();
+}
+
+void SpriteBatch::move(uint16_t index, int16_t x, int16_t y) {
+    if (index >= this->count) return;
+    this->xs[index] = x;
+    this->ys[index] = y;
+    this->touch();
+}
+
+void SpriteBatch::setFrame(uint16_t index, uint8_t frame) {
+    if (index >= this->count || frame >= this->frameCount) return;
+    this->frameIndices[index] = frame;
+    this->touch();
+}
+
+uint16_t SpriteBatch::size() const {
+    return this->count;
+}
+
+// the sprites write the color codes or the indices of their pixels
+static inline void drawSprite(const Sprite* sprite, int16_t x, int16_t y, screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) {
+    sprite->draw(x, y, sliceY, sliceHeight, buffer);
+}
+
+static inline void drawSprite(const Sprite* sprite, int16_t x, int16_t y, screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) {
+    sprite->drawIndexed(x, y, sliceY, sliceHeight, buffer);
+}
+
+// the visible sprites are sorted by the row on which they begin, in two
+// passes over the arrays: the sprites of each row are counted, then each one
+// is placed after those of the previous rows... the order of the sprites, and
+// so their overlaps, do not depend on the height of the slices
+void SpriteBatch::sort() {
+    uint8_t sliceHeight = Renderer::getSliceHeight();
+    uint8_t slices = Renderer::getSliceCount();
+    uint8_t tallest = 1;
+
+    // the sprites which begin above the screen are counted in its first row
+    uint16_t rows[SCREEN_HEIGHT + 1];
+    memset(rows, 0, sizeof(rows));
+    this->top = SCREEN_HEIGHT;
+    this->bottom = 0;
+
+    for (uint16_t i = 0; i < this->count; i++) {
+        const Sprite* frame = this->frames[this->frameIndices[i]];
+        int16_t x = this->xs[i];
+        int16_t y = this->ys[i];
+        // the sprites which are off the screen are left out
+        if (x + frame->width <= 0 || x >= SCREEN_WIDTH || y + frame->height <= 0 || y >= SCREEN_HEIGHT) continue;
+        rows[(y < 0 ? 0 : y) + 1]++;
+        if (y < this->top) this->top = y;
+        if (y + frame->height > this->bottom) this->bottom = y + frame->height;
+        if (frame->height > tallest) tallest = frame->height;
+    }
+
+    for (uint16_t r = 1; r < SCREEN_HEIGHT; r++) {
+        rows[r] += rows[r - 1];
+    }
+
+    // `rows[r]` is used as the cursor of the row `r` while placing
+    // the sprites, so that it ends up at the beginning of the row `r + 1`
+    for (uint16_t i = 0; i < this->count; i++) {
+        const Sprite* frame = this->frames[this->frameIndices[i]];
+        int16_t x = this->xs[i];
+        int16_t y = this->ys[i];
+        if (x + frame->width <= 0 || x >= SCREEN_WIDTH || y + frame->height <= 0 || y >= SCREEN_HEIGHT) continue;
+        this->order[rows[y < 0 ? 0 : y]++] = i;
+    }
+
+    // each slice begins with the sprites of its first row
+    this->starts[0] = 0;
+    for (uint8_t s = 1; s <= slices; s++) {
+        uint16_t end = s * sliceHeight;
+        this->starts[s] = rows[(end < SCREEN_HEIGHT ? end : SCREEN_HEIGHT) - 1];
+    }
+
+    // a sprite which begins on the last row of a slice
+    // extends over the next `(height - 1) / sliceHeight` slices, rounded up
+    this->reach = (tallest - 1 + sliceHeight - 1) / sliceHeight;
+    this->sortedSliceHeight = sliceHeight;
+    this->sorted = true;
+}
+
+// the sprites are sorted again after a change, or when
+// the partition of the screen in slices has changed
+void SpriteBatch::prepare() {
+    if (!this->sorted || this->sortedSliceHeight != Renderer::getSliceHeight()) this->sort();
+}
+
+int16_t SpriteBatch::getTop() {
+    this->prepare();
+    return this->top;
+}
+
+int16_t SpriteBatch::getBottom() {
+    this->prepare();
+    return this->bottom;
+}
+
+// the rows covered by the sprites before and after their changes are redrawn
+// > the extents are merged into a single range, which is enough for
+// > the sprites of a batch, usually scattered all over the screen
+void SpriteBatch::getChanges(int16_t& top, int16_t& bottom) {
+    if (!this->changed) {
+        top = bottom = 0;
+        return;
+    }
+    this->prepare();
+    top = this->top < this->drawnTop ? this->top : this->drawnTop;
+    bottom = this->bottom > this->drawnBottom ? this->bottom : this->drawnBottom;
+    this->drawnTop = this->top;
+    this->drawnBottom = this->bottom;
+    this->changed = false;
+}
+
+bool SpriteBatch::isReentrant() {
+    return true;
+}
+
+template <typename Pixel>
+void SpriteBatch::render(screen_y_t sliceY, uint8_t sliceHeight, Pixel* buffer) {
+    this->prepare();
+
+    // the sprites which begin in the previous `reach` slices may overlap this one
+    uint8_t slice = sliceY / this->sortedSliceHeight;
+    uint16_t first = this->starts[slice > this->reach ? slice - this->reach : 0];
+    uint16_t last = this->starts[slice + 1];
+
+    // in the front-to-back mode, the sprites are drawn in the reverse order,
+    // so that the same sprite ends up on top of the others
+    bool reverse = Renderer::getCoverage() != NULL;
+    for (uint16_t n = first; n < last; n++) {
+        uint16_t i = this->order[reverse ? first + last - 1 - n : n];
+        const Sprite* frame = this->frames[this->frameIndices[i]];
+        // the sprites of the previous slices may end above this one
+        if (this->ys[i] + frame->height <= sliceY) continue;
+        drawSprite(frame, this->xs[i], this->ys[i], sliceY, sliceHeight, buffer);
+    }
+}
+
+void SpriteBatch::draw(screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) {
+    this->render(sliceY, sliceHeight, buffer);
+}
+
+void SpriteBatch::drawIndexed(screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) {
+    this->render(sliceY, sliceHeight, buffer);
+}
@@ -0,0 +1,99 @@
+#ifndef SHADING_EFFECT_SPRITE_BATCH
+#define SHADING_EFFECT_SPRITE_BATCH
+
+#include "Renderable.h"
+#include "Renderer.h"
+#include "Sprite.h"
+#include "constants.h"
+
+// a whole crowd of sprites rendered by a single observer: bullets, particles...
+// each sprite only has a position and the index of its frame, stored in
+// separate arrays (a structure of arrays), so that they can be updated in
+// tight loops, and the `Renderer` only pays one virtual call per slice
+// for all of them
+// > at the beginning of each frame, the visible sprites are sorted by the
+// > row on which they begin (a counting sort), so that each slice only goes
+// > through the sprites which can overlap it
+// > the sprites are drawn in this order, then in the order of their indices:
+// > a sprite which begins lower is drawn over the ones above it, whatever
+// > the height of the slices
+class SpriteBatch : public Renderable
+{
+    private:
+
+        // the frames which the sprites can take
+        const Sprite* const* frames;
+        uint8_t frameCount;
+
+        // for each slice, the position in `order` of its first sprite,
+        // the sprites of the slice `s` being at `order[starts[s]...starts[s+1]-1]`
+        uint16_t starts[MAX_SLICE_COUNT + 1];
+        uint16_t* order;
+        // a sprite can extend beyond its first slice by `reach` slices at most
+        uint8_t reach;
+        // the slice height with which the sprites have been sorted
+        uint8_t sortedSliceHeight;
+        bool sorted;
+
+        // the vertical extent of the visible sprites, and the one
+        // they had when they were last drawn (empty if `top >= bottom`)
+        int16_t top, bottom;
+        int16_t drawnTop, drawnBottom;
+        bool changed;
+
+        // sorts the visible sprites by row
+        void sort();
+        void prepare();
+
+        // draws the sprites which overlap the slice, whatever the type of its pixels
+        template <typename Pixel>
+        void render(screen_y_t sliceY, uint8_t sliceHeight, Pixel* buffer);
+
+    protected:
+
+        uint16_t capacity;
+        uint16_t count;
+
+        // the sprites, in a structure of arrays
+        int16_t* xs;
+        int16_t* ys;
+        uint8_t* frameIndices;
+
+        // to be called by the derived classes after a direct
+        // modification of the arrays above
+        void touch();
+
+    public:
+
+        // the arrays of the batch are allocated once and for all
+        SpriteBatch(const Sprite* const* frames, uint8_t frameCount, uint16_t capacity);
+        ~SpriteBatch();
+
+        // adds a sprite, and returns its index (or -1 if the batch is full)
+        int16_t add(int16_t x, int16_t y, uint8_t frame);
+        // the last sprite takes the place of the removed one
+        void remove(uint16_t index);
+        void clear();
+
+        void move(uint16_t index, int16_t x, int16_t y);
+        void setFrame(uint16_t index, uint8_t frame);
+
+        uint16_t size() const;
+
+        // the vertical extent of the visible sprites
+        int16_t getTop() override;
+        int16_t getBottom() override;
+
+        // the rows the sprites have left or reached since the previous frame
+        void getChanges(int16_t& top, int16_t& bottom) override;
+
+        // the sprites are sorted before the rendering of the frame
+        // (by `getTop()`), so they are only read while drawing
+        bool isReentrant() override;
+
+        // only the sprites sorted in the slices which can reach the current one are drawn
+        void draw(screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) override;
+        void drawIndexed(screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) override;
+};
+
+#endif
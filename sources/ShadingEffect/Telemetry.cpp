@@ -0,0 +1,67 @@
+#include "Telemetry.h"
+
+#if TELEMETRY_ENABLED
+
+// the ring is empty by default
+TelemetryRecord Telemetry::records[TELEMETRY_RECORDS];
+uint8_t Telemetry::head = 0;
+uint8_t Telemetry::count = 0;
+uint8_t Telemetry::dropped = 0;
+
+uint16_t Telemetry::frame = 0;
+uint32_t Telemetry::frameStart = 0;
+uint8_t Telemetry::sentSlice = 0;
+
+void Telemetry::beginFrame() {
+    frame++;
+    frameStart = micros();
+}
+
+uint32_t Telemetry::now() {
+    return micros();
+}
+
+void Telemetry::record(uint8_t slice, uint8_t kind, uint32_t start) {
+    uint32_t end = micros();
+
+    // the slice sent to the DMA controller is remembered
+    // to be able to attribute it the waiting time
+    if (kind == TELEMETRY_SEND) sentSlice = slice;
+
+    // when the ring is full, the new events are lost
+    // until the next call to `flush()`
+    if (count == TELEMETRY_RECORDS) {
+        if (dropped < 0xff) dropped++;
+        return;
+    }
+
+    TelemetryRecord& record = records[(head + count) % TELEMETRY_RECORDS];
+    record.frame = frame;
+    record.slice = slice;
+    record.kind = kind;
+    record.start = start - frameStart;
+    record.duration = end - start;
+    count++;
+}
+
+void Telemetry::recordWait(uint32_t start) {
+    record(sentSlice, TELEMETRY_WAIT, start);
+}
+
+void Telemetry::flush() {
+    if (count == 0 && dropped == 0) return;
+
+    uint8_t header[4] = { 'T', 'L', count, dropped };
+    SerialUSB.write(header, sizeof(header));
+
+    // the ring may wrap around, in which case it is sent in two parts
+    uint8_t first = TELEMETRY_RECORDS - head < count ? TELEMETRY_RECORDS - head : count;
+    SerialUSB.write((const uint8_t*)(records + head), first * sizeof(TelemetryRecord));
+    SerialUSB.write((const uint8_t*)records, (count - first) * sizeof(TelemetryRecord));
+
+    head = (head + count) % TELEMETRY_RECORDS;
+    count = 0;
+    dropped = 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef SHADING_EFFECT_TELEMETRY
+#define SHADING_EFFECT_TELEMETRY
+
+#include <Gamebuino-Meta.h>
+
+// the telemetry is disabled by default: all its methods are then empty
+// and inlined, so that it costs absolutely nothing in the release builds...
+// set it to 1 to enable it (or pass -DTELEMETRY_ENABLED=1 to the compiler)
+#ifndef TELEMETRY_ENABLED
+#define TELEMETRY_ENABLED 0
+#endif
+
+// the number of events kept in the ring between two calls to `flush()`
+#define TELEMETRY_RECORDS 128
+
+// the kinds of events, in addition to the `Renderable::draw()` calls
+// which are identified by the position of the observer in the `Renderer`
+#define TELEMETRY_SEND 0xfe
+#define TELEMETRY_WAIT 0xff
+
+// an event of the rendering of a frame
+// > its durations are expressed in microseconds
+struct TelemetryRecord
+{
+    // the number of the frame (it wraps around)
+    uint16_t frame;
+    // the index of the slice
+    uint8_t slice;
+    // the position of the observer, `TELEMETRY_SEND` or `TELEMETRY_WAIT`
+    uint8_t kind;
+    // the beginning of the event, from the beginning of the frame
+    uint16_t start;
+    // the duration of the event
+    uint16_t duration;
+};
+
+// the events are streamed over `SerialUSB` by chunks, each made of a header
+// followed by `count` records of 8 bytes (little-endian), as they are in memory:
+//   'T' 'L' count dropped
+// where `dropped` is the number of events lost because the ring was full
+// > the `telemetry` host tool decodes this stream
+
+class Telemetry
+{
+#if TELEMETRY_ENABLED
+
+    private:
+
+        // the ring of events
+        static TelemetryRecord records[TELEMETRY_RECORDS];
+        static uint8_t head;
+        static uint8_t count;
+        static uint8_t dropped;
+
+        // the current frame
+        static uint16_t frame;
+        static uint32_t frameStart;
+
+        // the slice currently transferred to the DMA controller
+        static uint8_t sentSlice;
+
+    public:
+
+        // marks the beginning of a new frame
+        static void beginFrame();
+        // the current instant
+        static uint32_t now();
+        // records an event of the slice which began at `start`
+        static void record(uint8_t slice, uint8_t kind, uint32_t start);
+        // records the time spent waiting for the DMA controller
+        static void recordWait(uint32_t start);
+        // streams the recorded events over the serial port
+        static void flush();
+
+#else
+
+    public:
+
+        static inline void beginFrame() {}
+        static inline uint32_t now() { return 0; }
+        static inline void record(uint8_t, uint8_t, uint32_t) {}
+        static inline void recordWait(uint32_t) {}
+        static inline void flush() {}
+
+#endif
+};
+
+#endif
\ No newline at end of file
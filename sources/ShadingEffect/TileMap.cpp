@@ -0,0 +1,43 @@
+#include "TileMap.h"
+
+// a pure virtual destructor must be defined in an abstract class
+TileMap::~TileMap() = default;
+
+Checkerboard::~Checkerboard() {}
+
+// the color of a tile is given by the parity of its coordinates
+void Checkerboard::readChunk(int32_t, int32_t, uint8_t* tiles) {
+    // the chunks have an even size, so that they all hold the same pattern
+    for (uint8_t ty = 0; ty < CHUNK_SIZE; ty++) {
+        for (uint8_t tx = 0; tx < CHUNK_SIZE; tx++) {
+            *tiles++ = (tx ^ ty) & 1;
+        }
+    }
+}
+
+FlashTileMap::FlashTileMap(const uint8_t* tiles, uint16_t width, uint16_t height, uint8_t outside)
+    : tiles(tiles), width(width), height(height), outside(outside) {}
+
+FlashTileMap::~FlashTileMap() {}
+
+// the rows of the chunk are copied from the map,
+// and completed with the `outside` tile beyond its edges
+void FlashTileMap::readChunk(int32_t cx, int32_t cy, uint8_t* tiles) {
+    int32_t x0 = cx * CHUNK_SIZE;
+    int32_t y0 = cy * CHUNK_SIZE;
+
+    // the columns of the chunk which lie within the map
+    int32_t from = x0 < 0 ? -x0 : 0;
+    int32_t to = x0 + CHUNK_SIZE > this->width ? this->width - x0 : CHUNK_SIZE;
+
+    for (uint8_t ty = 0; ty < CHUNK_SIZE; ty++, tiles += CHUNK_SIZE) {
+        int32_t y = y0 + ty;
+        if (y < 0 || y >= this->height || from >= to) {
+            memset(tiles, this->outside, CHUNK_SIZE);
+            continue;
+        }
+        memset(tiles, this->outside, from);
+        memcpy(tiles + from, this->tiles + y * this->width + x0 + from, to - from);
+        memset(tiles + to, this->outside, CHUNK_SIZE - to);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef SHADING_EFFECT_TILE_MAP
+#define SHADING_EFFECT_TILE_MAP
+
+#include <Gamebuino-Meta.h>
+
+// the maps are cut into square chunks of tiles, which are the units
+// in which they are read from their storage (flash memory, SD card...)
+#define CHUNK_SIZE_POWER_OF_TWO 3
+#define CHUNK_SIZE (1 << CHUNK_SIZE_POWER_OF_TWO)
+
+// a map of tile indices, as large as you want: the tiling never reads it
+// directly, but only through a small cache of the chunks around the camera
+// (see `ChunkCache`), so that the map does not have to fit in RAM
+// > the tile indices refer to the tiles of the spritesheet of the `Tiling`
+// > (at most 32 types of tiles)
+class TileMap
+{
+    public:
+
+        // pure virtual destructor
+        virtual ~TileMap() = 0;
+
+        // fills `tiles` with the CHUNK_SIZE x CHUNK_SIZE tile indices of the chunk
+        // located at (cx,cy) in chunk coordinates, row after row
+        virtual void readChunk(int32_t cx, int32_t cy, uint8_t* tiles) = 0;
+};
+
+// the infinite checkerboard of light (0) and dark (1) tiles
+class Checkerboard : public TileMap
+{
+    public:
+
+        ~Checkerboard();
+
+        void readChunk(int32_t cx, int32_t cy, uint8_t* tiles) override;
+};
+
+// a map stored in flash memory as a `width` x `height` array of tile indices
+// > the tiles outside the map are replaced by the `outside` tile
+class FlashTileMap : public TileMap
+{
+    private:
+
+        const uint8_t* tiles;
+        uint16_t width;
+        uint16_t height;
+        uint8_t outside;
+
+    public:
+
+        FlashTileMap(const uint8_t* tiles, uint16_t width, uint16_t height, uint8_t outside);
+        ~FlashTileMap();
+
+        void readChunk(int32_t cx, int32_t cy, uint8_t* tiles) override;
+};
+
+#endif
\ No newline at end of file
@@ -2,56 +2,214 @@
 #define SHADING_EFFECT_TILING
 
 #include "Renderable.h"
+#include "constants.h"
+#include "Fixed.h"
+#include "ChunkCache.h"
+#include "LightMap.h"
+#include "DropShadow.h"
+#include "Palette.h"
+#include "Renderer.h"
+#include "Coverage.h"
+#include "ShadingKernels.h"
 
 // the constant driving impulse
-#define PULSE 1
+#define PULSE FIXED(1)
 
-// the distance calculations could be done quickly using
-// the square of the halo radius simply expressed as a power of 2
-#define HALO_RADIUS2_POWER_OF_TWO 11
+// the friction coefficient applied to the velocity at each frame,
+// and the speed under which the tiling stops...
+// > in Q19.12, the friction is 3686/4096 = 0.89990 instead of 0.9
+// > (a relative error of 1.1e-4) and each product is rounded to 1/4096
+#define FRICTION FIXED(.9)
+#define STOP_SPEED FIXED(.5)
 
-// and we can do the same with brightness levels
+// the square of the halo radius of the default tiling...
+// since the brightness levels are read from a precomputed table,
+// it no longer needs to be a power of 2
+#define DEFAULT_HALO_RADIUS2 2048
+
+// the brightness levels are still expressed as a power of 2
+// because they determine the layout of the `COLORMAP` palette...
+// this is the number of levels of the default tileset and of the `LightMap`
 #define BRIGHTNESS_LEVELS_POWER_OF_TWO 5
 
-// the Tiling class fulfills the contract defined in the `Renderable` interface
-class Tiling : public Renderable
+// the 4x4 Bayer matrix: the thresholds of the ordered dithering
+// of the brightness levels, spread as evenly as possible over the screen
+static const uint8_t BAYER_MATRIX[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+// the resolution of the brightness table: one entry
+// for every 2^LUX_TABLE_SHIFT values of the square of the distance
+#define LUX_TABLE_SHIFT 3
+
+// a tileset gathers the spritesheet of the tiles and its shaded palette,
+// with all their descriptive parameters known at compile time:
+//   TILE_WIDTH, TILE_HEIGHT   -> the size of the tiles
+//   TILE_COUNT                -> the number of tiles of the spritesheet
+//   COLOR_COUNT               -> the number of color indices of the spritesheet
+//   LEVELS_POWER_OF_TWO       -> the number of brightness levels of the palette
+//   BITMAP                    -> the color indices of the tiles, one after the other
+//   SHADES                    -> the shaded ramp of each color index
+//   SHADE_INDICES             -> the same ramps, as indices in the screen palette
+//                                of the indexed mode (see `ScreenPalette.h`)
+// the tileset of the checkerboard: a light tile and a dark tile
+struct DefaultTileset
+{
+    static constexpr uint8_t TILE_WIDTH = 16;
+    static constexpr uint8_t TILE_HEIGHT = 16;
+    static constexpr uint8_t TILE_COUNT = 2;
+    static constexpr uint8_t COLOR_COUNT = 5;
+    static constexpr uint8_t LEVELS_POWER_OF_TWO = BRIGHTNESS_LEVELS_POWER_OF_TWO;
+
+    // the pixel map obtained with the transcoding tool
+    // note the change in the type of values
+    // now stored in the spritesheet
+    static const uint8_t BITMAP[];
+
+    // the color palette associated with the spritesheet
+    // including all the luminous versions of the
+    // reference colors of our sprites... it is computed
+    // by the compiler from the colors found by `img2shading`
+    typedef PaletteShader<LEVELS_POWER_OF_TWO, LinearFalloff,
+        0xcccccc, 0xaaaaaa, 0x444444, 0x888888
+    > Shader;
+    typedef ShadedPalette<Shader> Palette;
+
+    // the shaded ramp of each color index of the spritesheet in `COLORMAP`,
+    // the transparent color being mapped to a ramp of black pixels
+    static const uint16_t DARKNESS[];
+    static const uint16_t* const SHADES[];
+    static const uint8_t DARKNESS_INDICES[];
+    static const uint8_t* const SHADE_INDICES[];
+};
+
+#if SHADING_KERNELS
+// the shaded ramps of a tileset split into planes of bytes,
+// as the shading kernels read them (see `ShadingTables`)
+template <class Tileset, typename Pixel>
+struct ShadePlanes
+{
+    static const uint16_t SIZE = (Tileset::COLOR_COUNT * sizeof(Pixel)) << Tileset::LEVELS_POWER_OF_TWO;
+    static uint8_t planes[SIZE];
+
+    static void init(const Pixel* const* shades) {
+        for (uint8_t c = 0; c < Tileset::COLOR_COUNT; c++) {
+            for (uint8_t b = 0; b < sizeof(Pixel); b++) {
+                for (uint16_t level = 0; level < (1 << Tileset::LEVELS_POWER_OF_TWO); level++) {
+                    planes[((c * sizeof(Pixel) + b) << Tileset::LEVELS_POWER_OF_TWO) + level] = shades[c][level] >> (8 * b);
+                }
+            }
+        }
+    }
+};
+
+template <class Tileset, typename Pixel>
+uint8_t ShadePlanes<Tileset, Pixel>::planes[ShadePlanes<Tileset, Pixel>::SIZE];
+#endif
+
+// the tiling renderer is specialized at compile time on its tileset and on
+// the size of its halo: all the divisions, modulos and shifts of the rendering
+// loop operate on constants, and several tilings configured differently
+// can coexist without paying for any runtime parameter
+// > a tiling is always opaque: it writes every pixel of the slice, and its dark
+// > pixels as well as the transparent color of its tileset are written in black...
+// > it can only be the background layer of the scene, never a foreground one
+// > the BasicTiling class fulfills the contract defined in the `Renderable` interface
+template <class Tileset, uint16_t HALO_RADIUS2>
+class BasicTiling : public Renderable
 {
     private:
 
-        // the descriptive parameters of the sprite
-        static const uint8_t TILE_WIDTH;
-        static const uint8_t TILE_HEIGHT;
+        // the types of tiles met on a row are tracked in a 32-bit mask,
+        // whose bits are shifted by the tile indices
+        static_assert(Tileset::TILE_COUNT <= 32, "a tileset holds at most 32 tiles");
+        // the brightness levels computed on `LUX_BITS` are reduced to those of the tileset
+        static_assert(Tileset::LEVELS_POWER_OF_TWO <= LUX_BITS, "the tileset has too many brightness levels");
+        // the window of the chunk cache must cover the visible tiles
+        static_assert(Tileset::TILE_WIDTH >= CHUNK_CACHE_TILE_SIZE && Tileset::TILE_HEIGHT >= CHUNK_CACHE_TILE_SIZE, "the tiles are too small for the chunk cache");
 
-        // the pixel map obtained with the transcoding tool
-        // note the change in the type of values
-        // now stored in the spritesheet
-        static const uint8_t BITMAP[];
+        // the shift from the brightness levels on `LUX_BITS` to those of the tileset
+        static const uint8_t LUX_SHIFT = LUX_BITS - Tileset::LEVELS_POWER_OF_TWO;
 
-        // the color palette associated with the spritesheet
-        // including all the luminous versions of the
-        // reference colors of our sprites
-        static const uint16_t COLORMAP[];
+        static const uint16_t LUX_TABLE_SIZE = (HALO_RADIUS2 + (1 << LUX_TABLE_SHIFT) - 1) >> LUX_TABLE_SHIFT;
+
+        // the brightness level (on `LUX_BITS`) as a function of the square
+        // of the distance to the center of the halo (see `LUX_TABLE_SHIFT`)
+        static uint8_t luxTable[LUX_TABLE_SIZE];
+
+        // the half-width of the halo for each vertical distance
+        // to its center, or `NO_HALO_SPAN` if the row is totally dark
+        static screen_x_t haloSpan[SCREEN_HEIGHT / 2 + 1];
+        static const screen_x_t NO_HALO_SPAN;
+
+        #if SHADING_KERNELS
+        // the brightness of each pixel of the screen lit by the halo,
+        // which the shading kernels read as a light map
+        static uint8_t haloLux[SCREEN_HEIGHT][SCREEN_WIDTH];
+        #endif
+
+        // precomputes the tables above
+        static void initHalo();
+
+        // the rendering of a slice, whatever the type of its pixels:
+        // color codes picked in `SHADES`, or indices picked in `SHADE_INDICES`
+        template <typename Pixel>
+        void render(screen_y_t sliceY, uint8_t sliceHeight, Pixel* buffer, const Pixel* const* shades);
+
+        #if SHADING_KERNELS
+        // the shading of the lit pixels [x0, x1) of a row by the installed kernels
+        template <typename Pixel>
+        void shadeGap(ShadingKernels* kernels, Pixel* out, int16_t x0, int16_t x1, screen_y_t y, int32_t ty, uint8_t yt, const uint8_t* lux, const uint8_t* thresholds);
+        #endif
 
         // the coordinates of the acceleration vector
-        float ax,ay;
+        fixed_t ax,ay;
 
         // the coordinates of the velocity vector
-        float vx,vy;
+        fixed_t vx,vy;
 
         // the coordinates of the position vector are no other than
-        // than those of our displacement vector
-        int8_t offsetX,offsetY;
+        // than those of our displacement vector, i.e. the position
+        // of the camera on the map, in pixels...
+        int32_t offsetX,offsetY;
+        // ...to which is added their fractional part, so that
+        // the slow motions are not lost between two frames
+        fixed_t subX,subY;
+
+        // the position displayed at the previous frame
+        int32_t drawnX,drawnY;
+        // flag which tells if the tiling has already been displayed
+        bool drawn;
+
+        // the infinite checkerboard displayed by default
+        static Checkerboard checkerboard;
+
+        // the chunks of the map located around the camera
+        ChunkCache cache;
+
+        // the light map sampled in place of the halo, if any
+        LightMap* lights;
+
+        // the drop shadow which darkens the tiling, if any
+        const DropShadow* shadow;
+
+        // flag which tells if the brightness levels are dithered
+        bool dithered;
 
     public:
 
         // a constructor is declared
         // we will initialize all the kinematics properties
-        // in this constructor
-        Tiling();
+        // in this constructor...
+        // the tiling displays the given map, or the checkerboard by default
+        BasicTiling(TileMap* map = NULL);
 
         // a destructor must be declared here to
         // avoid potential memory leaks
-        ~Tiling();
+        ~BasicTiling();
 
         // the move commands invoked by `GameEngine`
         void left();
@@ -62,8 +220,635 @@ class Tiling : public Renderable
         // the connection point of the control loop
         void tick();
 
+        // changes the map displayed by the tiling
+        void setMap(TileMap* map);
+
+        // the number of chunks read from the map since the beginning
+        // (this is used by the host replay to check the streaming)
+        uint32_t getChunkReadCount();
+
+        // the tiling is lit by the given light map (which must be subscribed
+        // to the `Renderer` as well), or by its own halo by default
+        void setLightMap(LightMap* lights);
+
+        // the tiling is darkened by the given drop shadow (NULL removes it)...
+        // the rows which it does not cross are rendered at the same cost as without it
+        void setShadow(const DropShadow* shadow);
+
+        // in the dithered mode, a screen-space Bayer threshold is added to the
+        // brightness levels before they are reduced to those of the tileset:
+        // the neighbouring pixels are spread over the two closest levels,
+        // so that the bands of the falloff fade out at the same cost per pixel
+        void setDithering(bool dithered);
+        bool isDithering();
+
+        // places the tiling directly at a given position
+        // (this is used by the host benchmark to sweep the offsets)
+        void setOffset(int32_t offsetX, int32_t offsetY);
+
+        // the position of the tiling, and its sub-pixel part
+        int32_t getOffsetX();
+        int32_t getOffsetY();
+        fixed_t getSubOffsetX();
+        fixed_t getSubOffsetY();
+
+        // the whole tiling changes as soon as it moves by one pixel...
+        // it's also the moment to stream the chunks around the camera
+        void getChanges(int16_t& top, int16_t& bottom) override;
+
+        // the tiling only reads the chunk cache and the halo tables while drawing,
+        // but the light map is prepared slice by slice
+        bool isReentrant() override;
+
         // the rendering method imposed by the `Renderable` contract
-        void draw(uint8_t sliceY, uint8_t sliceHeight, uint16_t* buffer) override;
+        void draw(screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) override;
+        void drawIndexed(screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) override;
 };
 
+// the tiling of the demo, with its checkerboard of 16x16 tiles
+typedef BasicTiling<DefaultTileset, DEFAULT_HALO_RADIUS2> Tiling;
+
+// the map displayed by default
+template <class Tileset, uint16_t HALO_RADIUS2>
+Checkerboard BasicTiling<Tileset, HALO_RADIUS2>::checkerboard;
+
+// the tables describing the light halo
+template <class Tileset, uint16_t HALO_RADIUS2>
+uint8_t BasicTiling<Tileset, HALO_RADIUS2>::luxTable[LUX_TABLE_SIZE];
+template <class Tileset, uint16_t HALO_RADIUS2>
+screen_x_t BasicTiling<Tileset, HALO_RADIUS2>::haloSpan[SCREEN_HEIGHT / 2 + 1];
+template <class Tileset, uint16_t HALO_RADIUS2>
+const screen_x_t BasicTiling<Tileset, HALO_RADIUS2>::NO_HALO_SPAN = (screen_x_t)~0;
+#if SHADING_KERNELS
+template <class Tileset, uint16_t HALO_RADIUS2>
+uint8_t BasicTiling<Tileset, HALO_RADIUS2>::haloLux[SCREEN_HEIGHT][SCREEN_WIDTH];
+#endif
+
+// the halo tables are computed once and for all, so that the rendering
+// no longer has to evaluate the falloff curve for each pixel
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::initHalo() {
+    // the brightness level is a linear function of the square of the distance
+    // (lux = 0 in the center of the halo, and the highest level at its edge)...
+    // any other falloff curve could be used here at no extra cost for the rendering
+    for (uint16_t i = 0; i < LUX_TABLE_SIZE; i++) {
+        luxTable[i] = ((uint32_t)(i << LUX_TABLE_SHIFT) << LUX_BITS) / HALO_RADIUS2;
+    }
+
+    // for each vertical distance `dy` to the center of the halo,
+    // we look for the largest `dx` such that dx^2 + dy^2 < HALO_RADIUS2
+    for (screen_y_t dy = 0; dy <= SCREEN_HEIGHT / 2; dy++) {
+        uint32_t dy2 = (uint32_t)dy * dy;
+        if (dy2 >= HALO_RADIUS2) {
+            haloSpan[dy] = NO_HALO_SPAN;
+        } else {
+            screen_x_t dx = 0;
+            while (dx < SCREEN_WIDTH / 2 && (dx + 1) * (dx + 1) + dy2 < HALO_RADIUS2) dx++;
+            haloSpan[dy] = dx;
+        }
+    }
+
+    #if SHADING_KERNELS
+    // the brightness of the pixels of the halo, i.e. of the pixels
+    // of the span of each row (the others are never read)
+    for (screen_y_t y = 0; y < SCREEN_HEIGHT; y++) {
+        int16_t dy = y - SCREEN_HEIGHT / 2;
+        screen_x_t span = haloSpan[dy < 0 ? -dy : dy];
+        for (screen_x_t x = 0; x < SCREEN_WIDTH; x++) {
+            int16_t dx = x - SCREEN_WIDTH / 2;
+            haloLux[y][x] = span != NO_HALO_SPAN && (dx < 0 ? -dx : dx) <= span ? luxTable[(dx * dx + dy * dy) >> LUX_TABLE_SHIFT] : 0;
+        }
+    }
+    #endif
+}
+
+// then comes the constructor, which initializes:
+// - the acceleration vector
+// - the veolcity vector
+// - the displacement vector
+template <class Tileset, uint16_t HALO_RADIUS2>
+BasicTiling<Tileset, HALO_RADIUS2>::BasicTiling(TileMap* map) : cache(map ? map : &checkerboard, Tileset::TILE_COUNT), lights(NULL), shadow(NULL), dithered(false) {
+    initHalo();
+    #if SHADING_KERNELS
+    ShadePlanes<Tileset, uint16_t>::init(Tileset::SHADES);
+    ShadePlanes<Tileset, uint8_t>::init(Tileset::SHADE_INDICES);
+    #endif
+    this->ax = 0;
+    this->ay = 0;
+    this->vx = 0;
+    this->vy = 0;
+    this->offsetX = 0;
+    this->offsetY = 0;
+    this->subX = 0;
+    this->subY = 0;
+    this->drawn = false;
+}
+
+// a destructor must be defined here to
+// avoid potential memory leaks
+template <class Tileset, uint16_t HALO_RADIUS2>
+BasicTiling<Tileset, HALO_RADIUS2>::~BasicTiling() {
+    // he's not doing anything special here,
+    // but it's important to think about it!
+}
+
+// the fundamental relationship of dynamics applies
+// here in a very simpl way :-)
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::left() {
+    this->ax = -PULSE;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::right() {
+    this->ax = PULSE;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::up() {
+    this->ay = -PULSE;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::down() {
+    this->ay = PULSE;
+}
+
+// connection to the control loop
+// is an opportunity to apply our motion equations
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::tick() {
+    // the velocity vector is directly derived
+    // from the acceleration vector
+    this->vx += this->ax;
+    this->vy += this->ay;
+
+    // the displacement vector is directly derived
+    // from the velocity vector... the whole pixels are transferred
+    // to the position of the camera, and only the fractional part is kept
+    this->subX += this->vx;
+    this->subY += this->vy;
+    this->offsetX += fixedFloor(this->subX);
+    this->offsetY += fixedFloor(this->subY);
+    this->subX = fixedFraction(this->subX);
+    this->subY = fixedFraction(this->subY);
+
+    // !watch out here!
+    // remember that acceleration is an INSTANT value
+    // so once it's been applied to the velocity vector,
+    // you must reset it to zero!
+    this->ax = 0;
+    this->ay = 0;
+
+    // application of the friction phenomenon:
+    this->vx = fixedMul(this->vx, FRICTION);
+    this->vy = fixedMul(this->vy, FRICTION);
+
+    // and we can also decide that when the components
+    // of the velocity become less than 0.5 (in absolute values),
+    // then we can consider that they simply cancel each other out
+    if (this->vx > -STOP_SPEED && this->vx < STOP_SPEED) { this->vx = 0; }
+    if (this->vy > -STOP_SPEED && this->vy < STOP_SPEED) { this->vy = 0; }
+}
+
+// the displayed map can be changed at any time
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::setMap(TileMap* map) {
+    this->cache.setMap(map ? map : &checkerboard);
+    this->drawn = false;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+uint32_t BasicTiling<Tileset, HALO_RADIUS2>::getChunkReadCount() {
+    return this->cache.getReadCount();
+}
+
+// the halo can be replaced at any time by a light map
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::setLightMap(LightMap* lights) {
+    this->lights = lights;
+    this->drawn = false;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::setShadow(const DropShadow* shadow) {
+    this->shadow = shadow;
+    this->drawn = false;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::setDithering(bool dithered) {
+    this->dithered = dithered;
+    this->drawn = false;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+bool BasicTiling<Tileset, HALO_RADIUS2>::isDithering() {
+    return this->dithered;
+}
+
+// the tiling can also be placed directly at a given position
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::setOffset(int32_t offsetX, int32_t offsetY) {
+    this->offsetX = offsetX;
+    this->offsetY = offsetY;
+    this->subX = 0;
+    this->subY = 0;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+int32_t BasicTiling<Tileset, HALO_RADIUS2>::getOffsetX() {
+    return this->offsetX;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+int32_t BasicTiling<Tileset, HALO_RADIUS2>::getOffsetY() {
+    return this->offsetY;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+fixed_t BasicTiling<Tileset, HALO_RADIUS2>::getSubOffsetX() {
+    return this->subX;
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+fixed_t BasicTiling<Tileset, HALO_RADIUS2>::getSubOffsetY() {
+    return this->subY;
+}
+
+// the tiles which are visible from the camera are those
+// between the corners of the screen, in the coordinates of the map
+// > the divisions round down, even for negative coordinates
+static inline int32_t floorDiv(int32_t a, int32_t b) {
+    return (a >= 0 ? a : a - b + 1) / b;
+}
+
+// the tiling must only be redrawn when its displayed position changes,
+// i.e. when the integer part of its offset changes
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::getChanges(int16_t& top, int16_t& bottom) {
+    // this method is called once per frame before the rendering,
+    // so the chunks around the camera are loaded here
+    this->cache.prepare(
+        floorDiv(this->offsetX, Tileset::TILE_WIDTH),
+        floorDiv(this->offsetY, Tileset::TILE_HEIGHT),
+        floorDiv(this->offsetX + SCREEN_WIDTH - 1, Tileset::TILE_WIDTH),
+        floorDiv(this->offsetY + SCREEN_HEIGHT - 1, Tileset::TILE_HEIGHT)
+    );
+
+    if (this->drawn && this->offsetX == this->drawnX && this->offsetY == this->drawnY) {
+        top = bottom = 0;
+    } else {
+        this->drawn = true;
+        this->drawnX = this->offsetX;
+        this->drawnY = this->offsetY;
+        top = 0;
+        bottom = SCREEN_HEIGHT;
+    }
+}
+
+template <class Tileset, uint16_t HALO_RADIUS2>
+bool BasicTiling<Tileset, HALO_RADIUS2>::isReentrant() {
+    return this->lights == NULL;
+}
+
+// the tiling writes the color codes of its pixels...
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::draw(screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) {
+    this->render(sliceY, sliceHeight, buffer, Tileset::SHADES);
+}
+
+// ...or their indices in the screen palette, in the indexed mode
+template <class Tileset, uint16_t HALO_RADIUS2>
+void BasicTiling<Tileset, HALO_RADIUS2>::drawIndexed(screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) {
+    this->render(sliceY, sliceHeight, buffer, Tileset::SHADE_INDICES);
+}
+
+// and we define the method for calculating the rendering of the tiling
+template <class Tileset, uint16_t HALO_RADIUS2>
+template <typename Pixel>
+void BasicTiling<Tileset, HALO_RADIUS2>::render(screen_y_t sliceY, uint8_t sliceHeight, Pixel* buffer, const Pixel* const* shades) {
+    // we will pre-calculate some parameters
+    // to optimize the processing time....
+
+    // the tiles are numbered according to the two axes X and Y
+    // of the map with indices that are named `tx` and `ty`...
+    // the type of the tile (tx,ty) is then read from the chunk cache
+    int32_t tx,ty;
+    uint8_t tile;
+
+    // and here is the size of a tile in the spritesheet, which holds
+    // all the types of tiles one after the other
+    const uint16_t nfo = Tileset::TILE_WIDTH * Tileset::TILE_HEIGHT;
+
+    // all pixels (sx,sy) of the current slice will be examined...
+    // it will then be necessary to switch from the (sx,sy) local coordinate
+    // system to the (x,y) global coordinate system of the screen...
+    // and `sx` is actually equivalent to `x` since the slice covers the entire
+    // width of the screen:
+    //   x = sx
+    //   y = sy + sliceY
+    // > `sy` remains on 8 bits whatever the size of the screen, while `x` and `y`
+    // > take the narrowest types able to cover it (see `constants.h`)
+    uint8_t sy;
+    screen_x_t x;
+    screen_y_t y;
+
+    // don't forget that we have to take into account the displacement vector
+    // (offsetX, offsetY) that will be applied to the tiling to give an impression
+    // of motion at the ball...
+    // we will therefore have to transpose our global coordinate system (x,y)
+    // into the coordinate system of the map:
+    //   xo = x + offsetX
+    //   yo = y + offsetY
+    // and, within the tile, the pixel (xt,yt)
+    int32_t xo,yo;
+    uint8_t xt,yt;
+
+    // the content of the tiles repeats every `TILE_WIDTH` pixels...
+    // so on each row, the current row of each type of tile met on the row
+    // is expanded once and for all into the shaded ramps of the palette
+    // (see `SHADES`): the pixels of the row are then copied by runs,
+    // one run per tile column, without any index calculation
+    // > `expanded` tells which types of tiles have already been expanded
+    const Pixel* rowShades[Tileset::TILE_COUNT][Tileset::TILE_WIDTH];
+    uint32_t expanded;
+
+    // the row of the spritesheet that is expanded in `rowShades`
+    const uint8_t* bitmapRow;
+
+    // the current row of the buffer, and the current run: its destination
+    // in the row, its source in `rowShades`, and the number of pixels it contains
+    Pixel* out;
+    Pixel* px;
+    const Pixel* const* shade;
+    uint8_t run;
+
+    // we will need to measure the square of the distance `r2`
+    // between the pixel of the tiling and the center of the screen....
+    // an intermediate calculation will determine
+    // the Y component of `r2` that will be named `ry2`
+    uint16_t r2,ry2;
+    const screen_x_t hsw = SCREEN_WIDTH / 2;
+    const screen_y_t hsh = SCREEN_HEIGHT / 2;
+
+    // since `r2` only grows by `dr2` between two consecutive pixels,
+    // with `dr2` itself growing by 2, it can be updated without any multiplication
+    int16_t dr2;
+
+    // on each row, only the pixels between `xmin` and `xmax`
+    // lie inside the light halo... all the others remain dark
+    int16_t dy,xmin,xmax;
+    screen_x_t span;
+
+    // when a light map is used, the brightness level of each pixel
+    // of the row is read from it instead
+    const uint8_t* lux = NULL;
+    if (this->lights) this->lights->prepare(sliceY, sliceHeight);
+
+    // in the dithered mode, the thresholds of the current row of the Bayer
+    // matrix, scaled to the gap between two levels of the tileset...
+    // the level `lux` is then reduced to `(lux + threshold) >> LUX_SHIFT`,
+    // and the darkest level, which may be exceeded by one, is brought back
+    // without any branch by subtracting `level >> LEVELS_POWER_OF_TWO`
+    // > they remain zero otherwise, which the shading kernels rely on
+    uint8_t thresholds[4] = { 0, 0, 0, 0 };
+    uint8_t level;
+
+    // in the front-to-back mode, the pixels covered by the nearer renderables
+    // are skipped: only the gaps [g0, g1) between them are drawn, in pieces
+    // ending at `end`
+    CoverageMask* coverage = Renderer::getCoverage();
+    int16_t g0,g1,end;
+
+    // the rows of the slice crossed by the drop shadow (none without it),
+    // the span [s0, s1] of the lit pixels it darkens on the current row
+    // and their attenuation, and the darkened brightness levels of the row
+    int16_t shadowFrom = 0, shadowTo = 0;
+    int16_t s0,s1;
+    const uint8_t* attenuation;
+    uint8_t darkened[SCREEN_WIDTH];
+    if (this->shadow) {
+        shadowFrom = this->shadow->getTop() - sliceY;
+        shadowTo = this->shadow->getBottom() - sliceY;
+    }
+
+    #if SHADING_KERNELS
+    // the kernels which may replace the loop below on the host
+    ShadingKernels* kernels = ShadingKernels::getInstalled();
+    #endif
+
+    // scanning of each row of the slice
+    for (sy = 0; sy < sliceHeight; sy++) {
+
+        // transition from the two-dimensional system of the slice
+        // to the one-dimensional system of the buffer
+        out = buffer + sy * SCREEN_WIDTH;
+
+        // transition from the local coordinate system of the slice
+        // to the global coordinate system of the screen
+        y = sliceY + sy;
+
+        // the vertical distance to the center of the halo
+        dy = y - hsh;
+
+        if (this->lights) {
+            // the light map gives the lit span of the row
+            // (xmin > xmax if the row is totally dark)
+            lux = this->lights->getRow(y, xmin, xmax);
+        } else {
+            // (the previous row may have been shaded from the drop shadow)
+            lux = NULL;
+
+            // the span of the halo on this row is read from the precomputed table
+            span = haloSpan[dy < 0 ? -dy : dy];
+
+            if (span == NO_HALO_SPAN) {
+                // the row lies entirely outside the halo
+                xmin = SCREEN_WIDTH;
+                xmax = -1;
+            } else {
+                xmin = hsw - span;
+                xmax = hsw + span;
+                if (xmin < 0) xmin = 0;
+                if (xmax > SCREEN_WIDTH - 1) xmax = SCREEN_WIDTH - 1;
+            }
+        }
+
+        // the Y component of the displacement vector is applied
+        // and the row of tiles is determined
+        yo = y + this->offsetY;
+        ty = floorDiv(yo, Tileset::TILE_HEIGHT);
+        yt = yo - ty * Tileset::TILE_HEIGHT;
+
+        // no type of tile has been expanded yet on this row
+        expanded = 0;
+
+        if (this->dithered) {
+            for (uint8_t i = 0; i < 4; i++) {
+                thresholds[i] = ((uint16_t)BAYER_MATRIX[y & 3][i] << LUX_SHIFT) >> 4;
+            }
+        }
+
+        // the Y component of the square of the distance that
+        // separates the pixel from the center of the screen
+        // is calculated
+        ry2 = dy * dy;
+
+        // under the drop shadow, the brightness levels of the lit pixels
+        // of the row are copied, and those of the shadowed ones are lowered
+        // by their attenuation (with saturation)... the row is then shaded
+        // from this copy, as from a row of the light map
+        if (sy >= shadowFrom && sy < shadowTo) {
+            attenuation = this->shadow->getRow(y, s0, s1);
+            if (s0 < xmin) {
+                attenuation += xmin - s0;
+                s0 = xmin;
+            }
+            if (s1 > xmax) s1 = xmax;
+            if (s0 <= s1) {
+                if (lux) {
+                    memcpy(darkened + xmin, lux + xmin, xmax - xmin + 1);
+                } else {
+                    r2 = (xmin - hsw) * (xmin - hsw) + ry2;
+                    dr2 = 2 * (xmin - hsw) + 1;
+                    for (x = xmin; x <= xmax; x++, r2 += dr2, dr2 += 2) {
+                        darkened[x] = luxTable[r2 >> LUX_TABLE_SHIFT];
+                    }
+                }
+                for (x = s0; x <= s1; x++) {
+                    uint16_t darker = darkened[x] + *attenuation++;
+                    darkened[x] = darker > DARKEST_LUX ? DARKEST_LUX : darker;
+                }
+                lux = darkened;
+            }
+        }
+
+        // the pixels to draw are those of the gaps [g0, g1) left by
+        // the nearer renderables in the front-to-back mode, or the whole row
+        g0 = 0;
+        g1 = SCREEN_WIDTH;
+        while (coverage ? coverage->nextGap(sy, g0, g1) : g0 < g1) {
+
+            // the dark pixels on the left of the span of the halo
+            // are plunged into darkness by filling them with zeros
+            if (g0 < xmin) {
+                end = g1 < xmin ? g1 : xmin;
+                memset(out + g0, 0, (end - g0) * sizeof(Pixel));
+                g0 = end;
+            }
+
+            // the lit pixels of the gap
+            end = g1 <= xmax ? g1 : xmax + 1;
+            #if SHADING_KERNELS
+            if (g0 < end && kernels) {
+                this->shadeGap(kernels, out, g0, end, y, ty, yt, lux, thresholds);
+                g0 = end;
+            }
+            #endif
+            if (g0 < end) {
+
+                // the square of the distance of the first pixel
+                // and its increment towards the next pixel
+                r2 = (g0 - hsw) * (g0 - hsw) + ry2;
+                dr2 = 2 * (g0 - hsw) + 1;
+
+                // the lit pixels are cut into runs, each of which
+                // stays within a single tile column
+                px = out + g0;
+                for (x = g0; x < end; x += run) {
+
+                    // the X component of the displacement vector is applied
+                    // and the column of tiles is determined
+                    xo = x + this->offsetX;
+                    tx = floorDiv(xo, Tileset::TILE_WIDTH);
+                    xt = xo - tx * Tileset::TILE_WIDTH;
+
+                    // the type of the tile is read from the cache of chunks,
+                    // and its current row is expanded if it's the first time
+                    // it is met on this row of the screen
+                    tile = this->cache.getTile(tx, ty);
+                    if (!(expanded & ((uint32_t)1 << tile))) {
+                        bitmapRow = Tileset::BITMAP + tile * nfo + yt * Tileset::TILE_WIDTH;
+                        for (uint8_t i = 0; i < Tileset::TILE_WIDTH; i++) {
+                            rowShades[tile][i] = shades[bitmapRow[i]];
+                        }
+                        expanded |= (uint32_t)1 << tile;
+                    }
+
+                    // the run goes to the end of the tile column or to the end of the lit pixels
+                    shade = rowShades[tile] + xt;
+                    run = Tileset::TILE_WIDTH - xt;
+                    if (run > end - x) run = end - x;
+
+                    // each pixel of the run picks its color code in its shaded ramp
+                    // at the brightness level given by the light map...
+                    if (lux) {
+                        if (this->dithered) {
+                            for (uint8_t i = 0; i < run; i++) {
+                                level = (lux[x + i] + thresholds[(x + i) & 3]) >> LUX_SHIFT;
+                                *px++ = (*shade++)[level - (level >> Tileset::LEVELS_POWER_OF_TWO)];
+                            }
+                            continue;
+                        }
+                        for (uint8_t i = 0; i < run; i++) {
+                            *px++ = (*shade++)[lux[x + i] >> LUX_SHIFT];
+                        }
+                        continue;
+                    }
+
+                    // ...or corresponding to its distance to the center of the halo
+                    if (this->dithered) {
+                        for (uint8_t i = 0; i < run; i++, r2 += dr2, dr2 += 2) {
+                            level = (luxTable[r2 >> LUX_TABLE_SHIFT] + thresholds[(x + i) & 3]) >> LUX_SHIFT;
+                            *px++ = (*shade++)[level - (level >> Tileset::LEVELS_POWER_OF_TWO)];
+                        }
+                        continue;
+                    }
+                    for (uint8_t i = 0; i < run; i++, r2 += dr2, dr2 += 2) {
+                        *px++ = (*shade++)[luxTable[r2 >> LUX_TABLE_SHIFT] >> LUX_SHIFT];
+                    }
+                }
+                g0 = end;
+            }
+
+            // and the dark pixels on the right of the span
+            if (g0 < g1) {
+                memset(out + g0, 0, (g1 - g0) * sizeof(Pixel));
+            }
+            g0 = g1;
+        }
+
+        // the whole row is now covered
+        if (coverage) coverage->coverRow(sy);
+    }
+}
+
+#if SHADING_KERNELS
+template <class Tileset, uint16_t HALO_RADIUS2>
+template <typename Pixel>
+void BasicTiling<Tileset, HALO_RADIUS2>::shadeGap(ShadingKernels* kernels, Pixel* out, int16_t x0, int16_t x1, screen_y_t y, int32_t ty, uint8_t yt, const uint8_t* lux, const uint8_t* thresholds) {
+    const uint16_t nfo = Tileset::TILE_WIDTH * Tileset::TILE_HEIGHT;
+
+    // the color indices of the pixels: the current row of each tile is copied
+    // whole at the place of its first pixel, so that all the copies have the
+    // same size (the pixels copied beyond the gap are simply ignored)...
+    // the pixel `x` of the gap is found at `colors[TILE_WIDTH + x - x0]`
+    uint8_t colors[SCREEN_WIDTH + 2 * Tileset::TILE_WIDTH];
+    int32_t xo,tx;
+    uint8_t xt;
+    for (int16_t x = x0; x < x1; x += Tileset::TILE_WIDTH - xt) {
+        xo = x + this->offsetX;
+        tx = floorDiv(xo, Tileset::TILE_WIDTH);
+        xt = xo - tx * Tileset::TILE_WIDTH;
+        memcpy(colors + Tileset::TILE_WIDTH + x - xt - x0, Tileset::BITMAP + this->cache.getTile(tx, ty) * nfo + yt * Tileset::TILE_WIDTH, Tileset::TILE_WIDTH);
+    }
+
+    const ShadingTables tables = { ShadePlanes<Tileset, Pixel>::planes, Tileset::COLOR_COUNT, Tileset::LEVELS_POWER_OF_TWO, LUX_SHIFT };
+    kernels->shade(out + x0, colors + Tileset::TILE_WIDTH, (lux ? lux : haloLux[y]) + x0, x1 - x0, thresholds, x0 & 3, tables);
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -1,7 +1,36 @@
 #ifndef SHADING_EFFECT_CONSTANTS
 #define SHADING_EFFECT_CONSTANTS
 
+#include <stdint.h>
+
+// the geometry of the display: the 160x128 screen of the console by default,
+// but a larger panel can be targeted by giving it to the compiler
+// (e.g. -DSCREEN_WIDTH=320 -DSCREEN_HEIGHT=240, see `host/CMakeLists.txt`)
+// > the width must remain a multiple of 8 (see `Renderer::stage()`)
+#ifndef SCREEN_WIDTH
 #define SCREEN_WIDTH 160
+#endif
+#ifndef SCREEN_HEIGHT
 #define SCREEN_HEIGHT 128
+#endif
+
+static_assert(SCREEN_WIDTH % 8 == 0, "the width of the screen must be a multiple of 8");
+
+// the abscissas and the ordinates of the screen, held on 8 bits as long as
+// they (and the bound of the loops which scan them) fit in them... only
+// the coordinates which span the whole screen take these types: those
+// within a slice, a tile or a sprite keep their 8 bits whatever the geometry,
+// so that the rendering of the console is not slowed down by the larger panels
+#if SCREEN_WIDTH < 256
+typedef uint8_t screen_x_t;
+#else
+typedef uint16_t screen_x_t;
+#endif
+
+#if SCREEN_HEIGHT < 256
+typedef uint8_t screen_y_t;
+#else
+typedef uint16_t screen_y_t;
+#endif
 
-#endif
\ No newline at end of file
+#endif
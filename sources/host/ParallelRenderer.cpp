@@ -0,0 +1,56 @@
+#include <Gamebuino-Meta.h>
+#include "ParallelRenderer.h"
+
+ParallelRenderer::ParallelRenderer(unsigned threads, uint8_t band)
+    : pool(threads), band(band ? band : 1), buffers(pool.size()), coverages(pool.size()),
+      frame(SCREEN_WIDTH * SCREEN_HEIGHT, 0) {
+    for (std::vector<uint16_t>& buffer : this->buffers) {
+        buffer.resize(SCREEN_WIDTH * MAX_SLICE_HEIGHT);
+    }
+}
+
+ParallelRenderer::~ParallelRenderer() {}
+
+// the telemetry of the renderer cannot record several threads at the same time
+static bool concurrent() {
+    #if TELEMETRY_ENABLED
+    return false;
+    #else
+    return Renderer::isConcurrent();
+    #endif
+}
+
+void ParallelRenderer::drawSlices(uint32_t dirtySlices) {
+    uint8_t sliceHeight = Renderer::getSliceHeight();
+
+    // the dirty slices, in order
+    std::vector<uint8_t> slices;
+    for (uint32_t mask = dirtySlices; mask; mask &= mask - 1) {
+        slices.push_back(__builtin_ctz(mask));
+    }
+    unsigned bands = (slices.size() + this->band - 1) / this->band;
+
+    // each task renders a band of dirty slices, slice after slice,
+    // in the buffer of its worker, then copies them into the frame
+    this->pool.run(bands, [&](unsigned task, unsigned worker) {
+        uint16_t* buffer = this->buffers[worker].data();
+        for (unsigned i = task * this->band; i < slices.size() && i < (task + 1) * this->band; i++) {
+            screen_y_t sliceY = slices[i] * sliceHeight;
+            uint8_t height = SCREEN_HEIGHT - sliceY < sliceHeight ? SCREEN_HEIGHT - sliceY : sliceHeight;
+            Renderer::renderSlice(slices[i], buffer, &this->coverages[worker]);
+            memcpy(this->frame.data() + sliceY * SCREEN_WIDTH, buffer, SCREEN_WIDTH * height * sizeof(uint16_t));
+        }
+    }, concurrent() ? 0 : 1);
+
+    // the slices are sent in order, once they are all rendered
+    for (uint8_t slice : slices) {
+        screen_y_t sliceY = slice * sliceHeight;
+        uint8_t height = SCREEN_HEIGHT - sliceY < sliceHeight ? SCREEN_HEIGHT - sliceY : sliceHeight;
+        gb.tft.setAddrWindow(0, sliceY, SCREEN_WIDTH - 1, sliceY + height - 1);
+        gb.tft.sendBuffer(this->frame.data() + sliceY * SCREEN_WIDTH, SCREEN_WIDTH * height);
+    }
+}
+
+const uint16_t* ParallelRenderer::getFrame() const {
+    return this->frame.data();
+}
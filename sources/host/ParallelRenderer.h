@@ -0,0 +1,43 @@
+#ifndef SHADING_EFFECT_HOST_PARALLEL_RENDERER
+#define SHADING_EFFECT_HOST_PARALLEL_RENDERER
+
+#include <vector>
+#include "Renderer.h"
+#include "Coverage.h"
+#include "ThreadPool.h"
+
+// the rendering backend of the host build, which spreads the slices of each frame
+// over a pool of threads: the dirty slices are grouped in bands of `band` slices,
+// each worker renders the bands it takes in its own slice buffer and coverage mask,
+// and copies them into the frame... the slices are then sent to the display
+// in order, exactly as the ring of buffers of the `Renderer` would
+// > the frame is only rendered in parallel when all the observers are reentrant
+// > (see `Renderable::isReentrant()`), and on a single thread otherwise
+// > the telemetry of the renderer is not thread-safe either: when it is enabled,
+// > the frame is rendered on a single thread as well
+class ParallelRenderer : public RenderBackend
+{
+    private:
+
+        ThreadPool pool;
+        uint8_t band;
+
+        // the slice buffer and the coverage mask of each worker
+        std::vector<std::vector<uint16_t>> buffers;
+        std::vector<CoverageMask> coverages;
+
+        // the last frame rendered
+        std::vector<uint16_t> frame;
+
+    public:
+
+        ParallelRenderer(unsigned threads, uint8_t band = 1);
+        ~ParallelRenderer();
+
+        void drawSlices(uint32_t dirtySlices) override;
+
+        // the last frame rendered, in byte-swapped RGB565
+        const uint16_t* getFrame() const;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned workers) : job(NULL), workers(0), active(0), generation(0), stopping(false) {
+    if (workers == 0) workers = 1;
+    for (unsigned w = 0; w < workers; w++) {
+        this->queues.emplace_back(new Queue());
+    }
+    for (unsigned w = 1; w < workers; w++) {
+        this->threads.emplace_back(&ThreadPool::loop, this, w);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->started.notify_all();
+    for (std::thread& thread : this->threads) thread.join();
+}
+
+unsigned ThreadPool::size() const {
+    return this->queues.size();
+}
+
+void ThreadPool::run(unsigned count, const Job& job, unsigned workers) {
+    if (workers == 0 || workers > this->size()) workers = this->size();
+
+    // the tasks are dealt out in contiguous ranges, so that each worker
+    // starts with neighbouring tasks
+    for (unsigned w = 0; w < workers; w++) {
+        Queue& queue = *this->queues[w];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (unsigned task = count * w / workers; task < count * (w + 1) / workers; task++) {
+            queue.tasks.push_back(task);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->job = &job;
+        this->workers = workers;
+        this->active = workers - 1;
+        this->generation++;
+    }
+    if (workers > 1) this->started.notify_all();
+
+    // the calling thread is the worker 0
+    this->work(0);
+
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->finished.wait(lock, [this] { return this->active == 0; });
+    this->job = NULL;
+}
+
+void ThreadPool::loop(unsigned worker) {
+    unsigned long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->started.wait(lock, [&] { return this->stopping || this->generation != seen; });
+            if (this->stopping) return;
+            seen = this->generation;
+            // the worker does not take part in this batch
+            if (worker >= this->workers) continue;
+        }
+
+        this->work(worker);
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (--this->active == 0) this->finished.notify_one();
+    }
+}
+
+void ThreadPool::work(unsigned worker) {
+    unsigned task;
+    while (this->next(worker, task)) {
+        (*this->job)(task, worker);
+    }
+}
+
+// the worker takes the next task of its own queue, or steals
+// the last task of the first queue which still has some
+bool ThreadPool::next(unsigned worker, unsigned& task) {
+    {
+        Queue& queue = *this->queues[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    for (unsigned i = 1; i < this->workers; i++) {
+        Queue& victim = *this->queues[(worker + i) % this->workers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
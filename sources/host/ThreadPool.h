@@ -0,0 +1,62 @@
+#ifndef SHADING_EFFECT_HOST_THREAD_POOL
+#define SHADING_EFFECT_HOST_THREAD_POOL
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a pool of worker threads which share out the tasks of a batch by work stealing:
+// the tasks are first dealt out evenly in the queues of the workers, each worker
+// takes its own tasks from the front of its queue and, once it's empty, steals
+// the tasks left at the back of the queues of the other workers
+// > the thread which runs a batch takes part in it as the worker 0,
+// > so a pool of one worker does not start any thread
+class ThreadPool
+{
+    public:
+
+        // a task of the batch, and the worker which runs it
+        typedef std::function<void(unsigned task, unsigned worker)> Job;
+
+        explicit ThreadPool(unsigned workers);
+        ~ThreadPool();
+
+        unsigned size() const;
+
+        // runs the tasks [0, count) of the batch over the first `workers`
+        // workers of the pool (all of them by default), and returns
+        // once they are all done
+        void run(unsigned count, const Job& job, unsigned workers = 0);
+
+    private:
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<unsigned> tasks;
+        };
+
+        std::vector<std::thread> threads;
+        std::vector<std::unique_ptr<Queue>> queues;
+
+        // the current batch: the threads wake up when `generation` changes,
+        // and the batch is over when `active` falls back to zero
+        std::mutex mutex;
+        std::condition_variable started;
+        std::condition_variable finished;
+        const Job* job;
+        unsigned workers;
+        unsigned active;
+        unsigned long generation;
+        bool stopping;
+
+        void loop(unsigned worker);
+        void work(unsigned worker);
+        bool next(unsigned worker, unsigned& task);
+};
+
+#endif
@@ -0,0 +1,260 @@
+#include <string.h>
+#include "VectorKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VECTOR_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// the scalar shading, which also finishes the pixels left over by the vectorized ones
+template <typename Pixel>
+static void shadeScalar(Pixel* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) {
+    const uint8_t lp = tables.levelsPowerOfTwo;
+    uint8_t level;
+    for (uint16_t i = 0; i < count; i++) {
+        level = (lux[i] + thresholds[(phase + i) & 3]) >> tables.luxShift;
+        level -= level >> lp;
+        const uint8_t* entry = tables.planes + ((colors[i] * sizeof(Pixel)) << lp) + level;
+        Pixel pixel = 0;
+        for (uint8_t b = 0; b < sizeof(Pixel); b++) {
+            pixel |= (Pixel)entry[b << lp] << (8 * b);
+        }
+        out[i] = pixel;
+    }
+}
+
+class ScalarKernels : public ShadingKernels
+{
+    public:
+
+        const char* getName() override {
+            return "scalar";
+        }
+
+        void shade(uint16_t* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) override {
+            shadeScalar(out, colors, lux, count, thresholds, phase, tables);
+        }
+
+        void shade(uint8_t* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) override {
+            shadeScalar(out, colors, lux, count, thresholds, phase, tables);
+        }
+};
+
+#if VECTOR_KERNELS_X86
+
+// the thresholds of 4 consecutive pixels starting at `phase`, in the bytes
+// of a 32-bit word: since the Bayer pattern repeats every 4 pixels,
+// it is the same word for all the vectors
+static uint32_t thresholdPattern(const uint8_t* thresholds, uint8_t phase) {
+    uint32_t pattern;
+    memcpy(&pattern, thresholds, 4);
+    uint8_t shift = (phase & 3) * 8;
+    return shift ? pattern >> shift | pattern << (32 - shift) : pattern;
+}
+
+// the vectorized kernels look up 16 entries of a ramp at a time with a byte
+// shuffle: the levels are computed on 16 bits, exactly as the scalar expression
+// `level - (level >> levelsPowerOfTwo)` with `level = (lux + threshold) >> luxShift`,
+// then each plane of the ramp of each color index met in the vector is looked up
+// 16 entries at a time, and the results are kept where the color index matches
+// > the number of chunks of 16 entries of the ramps is a parameter of the template,
+// > so that all the loops over the chunks and the planes are unrolled
+template <typename Pixel, uint8_t CHUNKS>
+__attribute__((target("ssse3")))
+static void shadeSsse3(Pixel* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) {
+    const uint8_t lp = tables.levelsPowerOfTwo;
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i t = _mm_set1_epi32(thresholdPattern(thresholds, phase));
+    const __m128i tlo = _mm_unpacklo_epi8(t, zero);
+    const __m128i thi = _mm_unpackhi_epi8(t, zero);
+    const __m128i shift = _mm_cvtsi32_si128(tables.luxShift);
+    const __m128i clamp = _mm_cvtsi32_si128(lp);
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+
+    uint16_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(lux + i));
+        __m128i lo = _mm_srl_epi16(_mm_add_epi16(_mm_unpacklo_epi8(v, zero), tlo), shift);
+        __m128i hi = _mm_srl_epi16(_mm_add_epi16(_mm_unpackhi_epi8(v, zero), thi), shift);
+        lo = _mm_sub_epi16(lo, _mm_srl_epi16(lo, clamp));
+        hi = _mm_sub_epi16(hi, _mm_srl_epi16(hi, clamp));
+        __m128i levels = _mm_packus_epi16(lo, hi);
+
+        // the position of each level within its chunk of 16 entries, and its chunk
+        __m128i entry = _mm_and_si128(levels, nibble);
+        __m128i chunk = _mm_and_si128(_mm_srli_epi16(levels, 4), nibble);
+        __m128i select[CHUNKS];
+        for (uint8_t k = 1; k < CHUNKS; k++) select[k] = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(k));
+
+        __m128i c = _mm_loadu_si128((const __m128i*)(colors + i));
+        __m128i planes[sizeof(Pixel)];
+        for (uint8_t b = 0; b < sizeof(Pixel); b++) planes[b] = zero;
+
+        for (uint8_t color = 0; color < tables.colorCount; color++) {
+            __m128i match = _mm_cmpeq_epi8(c, _mm_set1_epi8(color));
+            if (!_mm_movemask_epi8(match)) continue;
+            for (uint8_t b = 0; b < sizeof(Pixel); b++) {
+                const uint8_t* ramp = tables.planes + ((color * sizeof(Pixel) + b) << lp);
+                __m128i value = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)ramp), entry);
+                for (uint8_t k = 1; k < CHUNKS; k++) {
+                    __m128i other = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(ramp + 16 * k)), entry);
+                    value = _mm_or_si128(_mm_andnot_si128(select[k], value), _mm_and_si128(select[k], other));
+                }
+                planes[b] = _mm_or_si128(planes[b], _mm_and_si128(match, value));
+            }
+        }
+
+        if (sizeof(Pixel) == 1) {
+            _mm_storeu_si128((__m128i*)(out + i), planes[0]);
+        } else {
+            _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi8(planes[0], planes[sizeof(Pixel) - 1]));
+            _mm_storeu_si128((__m128i*)(out + i + 8), _mm_unpackhi_epi8(planes[0], planes[sizeof(Pixel) - 1]));
+        }
+    }
+    shadeScalar(out + i, colors + i, lux + i, count - i, thresholds, phase + i, tables);
+}
+
+// the ramps of less than 16 levels are left to the scalar kernel
+template <typename Pixel>
+static void shadeSsse3(Pixel* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) {
+    switch (tables.levelsPowerOfTwo) {
+        case 4: shadeSsse3<Pixel, 1>(out, colors, lux, count, thresholds, phase, tables); break;
+        case 5: shadeSsse3<Pixel, 2>(out, colors, lux, count, thresholds, phase, tables); break;
+        case 6: shadeSsse3<Pixel, 4>(out, colors, lux, count, thresholds, phase, tables); break;
+        case 7: shadeSsse3<Pixel, 8>(out, colors, lux, count, thresholds, phase, tables); break;
+        case 8: shadeSsse3<Pixel, 16>(out, colors, lux, count, thresholds, phase, tables); break;
+        default: shadeScalar(out, colors, lux, count, thresholds, phase, tables);
+    }
+}
+
+// the same on 32 pixels, the chunks of the ramps being copied in both lanes...
+// the unpacking and the packing work within each 128-bit lane, so the levels
+// keep the order of the pixels, but the color codes must be put back in order
+// > the upper halves of the registers are cleared before the SSSE3 kernel
+// > takes over the last pixels, which would be slowed down otherwise
+template <typename Pixel, uint8_t CHUNKS>
+__attribute__((target("avx2")))
+static void shadeAvx2(Pixel* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) {
+    const uint8_t lp = tables.levelsPowerOfTwo;
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i t = _mm256_set1_epi32(thresholdPattern(thresholds, phase));
+    const __m256i tlo = _mm256_unpacklo_epi8(t, zero);
+    const __m256i thi = _mm256_unpackhi_epi8(t, zero);
+    const __m128i shift = _mm_cvtsi32_si128(tables.luxShift);
+    const __m128i clamp = _mm_cvtsi32_si128(lp);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+    uint16_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(lux + i));
+        __m256i lo = _mm256_srl_epi16(_mm256_add_epi16(_mm256_unpacklo_epi8(v, zero), tlo), shift);
+        __m256i hi = _mm256_srl_epi16(_mm256_add_epi16(_mm256_unpackhi_epi8(v, zero), thi), shift);
+        lo = _mm256_sub_epi16(lo, _mm256_srl_epi16(lo, clamp));
+        hi = _mm256_sub_epi16(hi, _mm256_srl_epi16(hi, clamp));
+        __m256i levels = _mm256_packus_epi16(lo, hi);
+
+        __m256i entry = _mm256_and_si256(levels, nibble);
+        __m256i chunk = _mm256_and_si256(_mm256_srli_epi16(levels, 4), nibble);
+        __m256i select[CHUNKS];
+        for (uint8_t k = 1; k < CHUNKS; k++) select[k] = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(k));
+
+        __m256i c = _mm256_loadu_si256((const __m256i*)(colors + i));
+        __m256i planes[sizeof(Pixel)];
+        for (uint8_t b = 0; b < sizeof(Pixel); b++) planes[b] = zero;
+
+        for (uint8_t color = 0; color < tables.colorCount; color++) {
+            __m256i match = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(color));
+            if (_mm256_testz_si256(match, match)) continue;
+            for (uint8_t b = 0; b < sizeof(Pixel); b++) {
+                const uint8_t* ramp = tables.planes + ((color * sizeof(Pixel) + b) << lp);
+                __m256i value = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)ramp)), entry);
+                for (uint8_t k = 1; k < CHUNKS; k++) {
+                    __m256i other = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(ramp + 16 * k))), entry);
+                    value = _mm256_blendv_epi8(value, other, select[k]);
+                }
+                planes[b] = _mm256_or_si256(planes[b], _mm256_and_si256(match, value));
+            }
+        }
+
+        if (sizeof(Pixel) == 1) {
+            _mm256_storeu_si256((__m256i*)(out + i), planes[0]);
+        } else {
+            // the pixels 0-7 and 16-23, then 8-15 and 24-31
+            __m256i first = _mm256_unpacklo_epi8(planes[0], planes[sizeof(Pixel) - 1]);
+            __m256i second = _mm256_unpackhi_epi8(planes[0], planes[sizeof(Pixel) - 1]);
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_permute2x128_si256(first, second, 0x20));
+            _mm256_storeu_si256((__m256i*)(out + i + 16), _mm256_permute2x128_si256(first, second, 0x31));
+        }
+    }
+    _mm256_zeroupper();
+    shadeSsse3<Pixel, CHUNKS>(out + i, colors + i, lux + i, count - i, thresholds, phase + i, tables);
+}
+
+template <typename Pixel>
+static void shadeAvx2(Pixel* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) {
+    switch (tables.levelsPowerOfTwo) {
+        case 4: shadeAvx2<Pixel, 1>(out, colors, lux, count, thresholds, phase, tables); break;
+        case 5: shadeAvx2<Pixel, 2>(out, colors, lux, count, thresholds, phase, tables); break;
+        case 6: shadeAvx2<Pixel, 4>(out, colors, lux, count, thresholds, phase, tables); break;
+        case 7: shadeAvx2<Pixel, 8>(out, colors, lux, count, thresholds, phase, tables); break;
+        case 8: shadeAvx2<Pixel, 16>(out, colors, lux, count, thresholds, phase, tables); break;
+        default: shadeScalar(out, colors, lux, count, thresholds, phase, tables);
+    }
+}
+
+class Ssse3Kernels : public ShadingKernels
+{
+    public:
+
+        const char* getName() override {
+            return "ssse3";
+        }
+
+        void shade(uint16_t* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) override {
+            shadeSsse3(out, colors, lux, count, thresholds, phase, tables);
+        }
+
+        void shade(uint8_t* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) override {
+            shadeSsse3(out, colors, lux, count, thresholds, phase, tables);
+        }
+};
+
+class Avx2Kernels : public ShadingKernels
+{
+    public:
+
+        const char* getName() override {
+            return "avx2";
+        }
+
+        void shade(uint16_t* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) override {
+            shadeAvx2(out, colors, lux, count, thresholds, phase, tables);
+        }
+
+        void shade(uint8_t* out, const uint8_t* colors, const uint8_t* lux, uint16_t count, const uint8_t* thresholds, uint8_t phase, const ShadingTables& tables) override {
+            shadeAvx2(out, colors, lux, count, thresholds, phase, tables);
+        }
+};
+
+#endif
+
+ShadingKernels* VectorKernels::get(const char* name) {
+    static ScalarKernels scalar;
+    #if VECTOR_KERNELS_X86
+    static Ssse3Kernels ssse3;
+    static Avx2Kernels avx2;
+    __builtin_cpu_init();
+    bool hasSsse3 = __builtin_cpu_supports("ssse3");
+    bool hasAvx2 = __builtin_cpu_supports("avx2");
+
+    if (!strcmp(name, "auto")) return hasAvx2 ? (ShadingKernels*)&avx2 : hasSsse3 ? (ShadingKernels*)&ssse3 : &scalar;
+    if (!strcmp(name, "ssse3")) return hasSsse3 ? &ssse3 : NULL;
+    if (!strcmp(name, "avx2")) return hasAvx2 ? &avx2 : NULL;
+    #else
+    if (!strcmp(name, "auto")) return &scalar;
+    #endif
+    if (!strcmp(name, "scalar")) return &scalar;
+    return NULL;
+}
@@ -0,0 +1,21 @@
+#ifndef SHADING_EFFECT_HOST_VECTOR_KERNELS
+#define SHADING_EFFECT_HOST_VECTOR_KERNELS
+
+#include "ShadingKernels.h"
+
+// the shading kernels of the host build (see `ShadingKernels.h`):
+//   scalar -> one pixel at a time, on any host
+//   ssse3  -> 16 pixels at a time, the ramps being looked up by byte shuffles
+//   avx2   -> 32 pixels at a time, in the same way
+// > the vectorized kernels are compiled for their instruction set whatever
+// > the options of the build, and are only used if the CPU supports it
+class VectorKernels
+{
+    public:
+
+        // the kernels of the given name, or the fastest ones supported
+        // by the CPU for "auto"... NULL if they are unknown or unsupported
+        static ShadingKernels* get(const char* name);
+};
+
+#endif
@@ -0,0 +1,358 @@
+// frame benchmark of the rendering engine on the host machine
+//
+// usage: bench [options]
+//   --frames <n>          -> number of frames rendered for each position of the tiling (default 200)
+//   --step <n>            -> step of the sweep of the tiling offsets, in pixels (default 8)
+//   --slices <h> <n>      -> the height of the slices and the number of buffers in the ring
+//                            of the renderer (default DEFAULT_SLICE_HEIGHT and DEFAULT_BUFFER_COUNT)
+//   --lights <n>          -> number of lights of a light map which replaces the halo of the tiling
+//                            (default 0, i.e. the halo)
+//   --front-to-back       -> draws the observers from front to back, skipping
+//                            the pixels they cover (by default, the painter's algorithm)
+//   --sparks <n>          -> number of sparks scattered over the screen, drawn by a single
+//                            sprite batch in the foreground (default 0)
+//   --dither              -> dithers the brightness levels of the tiling
+//   --indexed             -> renders 8-bit indices in the slices, expanded through
+//                            the screen palette before being sent
+//   --kernels <name>      -> the shading kernels of the tiling: reference (its own rendering
+//                            loop, by default), scalar, ssse3, avx2, or auto for the fastest
+//                            ones supported by the CPU... the checksum must not depend on them
+//   --shadow              -> darkens the tiling with the drop shadow of the ball
+//   --roll                -> rolls the ball by one step at each frame, so that a new frame
+//                            of its animation is decoded each time (by default, the first frame)
+//   --bricks              -> replaces the tiling of the demo by a wall of bricks, which
+//                            specializes `BasicTiling` on another tileset and halo
+//   --checksum <hex>      -> fails if the checksum of the run differs (for the test suite)
+//
+// the tiling is swept over a whole period of the checkerboard (32x32 pixels)
+// and, for each position, we report the time spent per frame, per slice
+// and per call of `Renderable::draw()`
+//
+// when the telemetry is enabled (cmake -DTELEMETRY=ON), its binary stream
+// is written to `telemetry.bin`, to be decoded with the `telemetry` tool
+
+#include <Gamebuino-Meta.h>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include "Renderer.h"
+#include "Tiling.h"
+#include "Ball.h"
+#include "LightMap.h"
+#include "Sparks.h"
+#include "ScreenPalette.h"
+#include "VectorKernels.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// a second tileset, so that `BasicTiling` is compiled with other constants:
+// bricks of 32x16 pixels with 16 brightness levels, which take their ramps
+// in those of the default tileset (the brightest half of each one)
+struct BrickTileset
+{
+    static constexpr uint8_t TILE_WIDTH = 32;
+    static constexpr uint8_t TILE_HEIGHT = 16;
+    static constexpr uint8_t TILE_COUNT = 3;
+    static constexpr uint8_t COLOR_COUNT = DefaultTileset::COLOR_COUNT;
+    static constexpr uint8_t LEVELS_POWER_OF_TWO = 4;
+
+    // the bitmap is drawn by `init()`
+    static uint8_t BITMAP[TILE_WIDTH * TILE_HEIGHT * TILE_COUNT];
+    static const uint16_t* const* SHADES;
+    static const uint8_t* const* SHADE_INDICES;
+
+    // each brick has a light top edge and a dark bottom edge, its mortar
+    // (the transparent color) is left dark, and it is cracked along
+    // a diagonal which depends on the tile
+    static void init() {
+        for (uint8_t t = 0; t < TILE_COUNT; t++) {
+            for (uint8_t y = 0; y < TILE_HEIGHT; y++) {
+                for (uint8_t x = 0; x < TILE_WIDTH; x++) {
+                    uint8_t color = t == 1 ? 4 : 2;
+                    if (y == 0) color = 1;
+                    if (y == TILE_HEIGHT - 2) color = 3;
+                    if (y == TILE_HEIGHT - 1 || x == 0) color = 0;
+                    if (t && (x + t * y) % TILE_WIDTH == 7) color = 3;
+                    BITMAP[(t * TILE_HEIGHT + y) * TILE_WIDTH + x] = color;
+                }
+            }
+        }
+    }
+};
+
+uint8_t BrickTileset::BITMAP[];
+const uint16_t* const* BrickTileset::SHADES = DefaultTileset::SHADES;
+const uint8_t* const* BrickTileset::SHADE_INDICES = DefaultTileset::SHADE_INDICES;
+
+// with a narrower halo than the one of the demo
+typedef BasicTiling<BrickTileset, 1200> BrickTiling;
+
+// the settings shared by the two tilings
+template <class T>
+static void setUpTiling(T& tiling, LightMap* lights, bool dither, const DropShadow* shadow) {
+    tiling.setLightMap(lights);
+    tiling.setDithering(dither);
+    tiling.setShadow(shadow);
+}
+
+static uint64_t elapsed(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+// a probe is subscribed to the `Renderer` in place of the observer it
+// encapsulates, and measures the time spent in each of its `draw()` calls,
+// as well as in its `getChanges()` calls (where the ball decodes its frames)
+class Probe : public Renderable
+{
+    private:
+
+        Renderable* renderable;
+
+    public:
+
+        const char* name;
+        uint64_t ns;
+        uint32_t calls;
+        uint64_t changesNs;
+        uint32_t changesCalls;
+
+        Probe(const char* name, Renderable* renderable) : renderable(renderable), name(name), ns(0), calls(0), changesNs(0), changesCalls(0) {}
+        ~Probe() {}
+
+        void reset() {
+            this->ns = 0;
+            this->calls = 0;
+            this->changesNs = 0;
+            this->changesCalls = 0;
+        }
+
+        int16_t getTop() override {
+            return this->renderable->getTop();
+        }
+
+        int16_t getBottom() override {
+            return this->renderable->getBottom();
+        }
+
+        void getChanges(int16_t& top, int16_t& bottom) override {
+            Clock::time_point start = Clock::now();
+            this->renderable->getChanges(top, bottom);
+            this->changesNs += elapsed(start);
+            this->changesCalls++;
+        }
+
+        void draw(screen_y_t sliceY, uint8_t sliceHeight, uint16_t* buffer) override {
+            Clock::time_point start = Clock::now();
+            this->renderable->draw(sliceY, sliceHeight, buffer);
+            this->ns += elapsed(start);
+            this->calls++;
+        }
+
+        void drawIndexed(screen_y_t sliceY, uint8_t sliceHeight, uint8_t* buffer) override {
+            Clock::time_point start = Clock::now();
+            this->renderable->drawIndexed(sliceY, sliceHeight, buffer);
+            this->ns += elapsed(start);
+            this->calls++;
+        }
+};
+
+// a FNV-1a hash of the emulated screen, to check that
+// an optimization does not change the rendered image
+static uint32_t checksum() {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < ST7735_TFTWIDTH * ST7735_TFTHEIGHT; i++) {
+        uint16_t pixel = gb.tft.framebuffer[i];
+        hash = (hash ^ (pixel & 0xff)) * 16777619u;
+        hash = (hash ^ (pixel >> 8)) * 16777619u;
+    }
+    return hash;
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = 200;
+    uint8_t step = 8;
+    uint8_t sliceHeight = DEFAULT_SLICE_HEIGHT;
+    uint8_t buffers = DEFAULT_BUFFER_COUNT;
+    uint8_t lightCount = 0;
+    bool frontToBack = false;
+    uint16_t sparkCount = 0;
+    bool dither = false;
+    bool indexed = false;
+    const char* kernels = "reference";
+    bool withShadow = false;
+    bool roll = false;
+    bool bricks = false;
+    const char* expectedChecksum = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--step") && i + 1 < argc) {
+            step = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--slices") && i + 2 < argc) {
+            sliceHeight = atoi(argv[++i]);
+            buffers = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--lights") && i + 1 < argc) {
+            lightCount = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--front-to-back")) {
+            frontToBack = true;
+        } else if (!strcmp(argv[i], "--sparks") && i + 1 < argc) {
+            sparkCount = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--dither")) {
+            dither = true;
+        } else if (!strcmp(argv[i], "--indexed")) {
+            indexed = true;
+        } else if (!strcmp(argv[i], "--kernels") && i + 1 < argc) {
+            kernels = argv[++i];
+        } else if (!strcmp(argv[i], "--shadow")) {
+            withShadow = true;
+        } else if (!strcmp(argv[i], "--roll")) {
+            roll = true;
+        } else if (!strcmp(argv[i], "--bricks")) {
+            bricks = true;
+        } else if (!strcmp(argv[i], "--checksum") && i + 1 < argc) {
+            expectedChecksum = argv[++i];
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            fprintf(stderr, "usage: %s [--frames <n>] [--step <n>] [--slices <h> <n>] [--lights <n>] [--front-to-back] [--sparks <n>] [--dither] [--indexed] [--kernels <name>] [--shadow] [--roll] [--bricks] [--checksum <hex>]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (frames == 0) frames = 1;
+    if (step == 0) step = 1;
+    if (lightCount > MAX_LIGHTS) lightCount = MAX_LIGHTS;
+
+    Renderer::setPalette(ScreenPalette::COLORMAP);
+    if (!Renderer::configure(sliceHeight, buffers, indexed)) {
+        fprintf(stderr, "%u buffers of %u rows do not fit in the arena of the renderer\n", buffers, sliceHeight);
+        return 1;
+    }
+
+    Renderer::setFrontToBack(frontToBack);
+
+    if (strcmp(kernels, "reference")) {
+        ShadingKernels* selected = VectorKernels::get(kernels);
+        if (selected == NULL) {
+            fprintf(stderr, "the %s shading kernels are not available on this host\n", kernels);
+            return 77;
+        }
+        ShadingKernels::install(selected);
+        kernels = selected->getName();
+    }
+
+    BrickTileset::init();
+    Tiling tiling;
+    BrickTiling brickTiling;
+    Ball ball;
+    LightMap lights;
+    Sparks sparks(sparkCount ? sparkCount : 1);
+    Probe tilingProbe(bricks ? "BrickTiling" : "Tiling", bricks ? (Renderable*)&brickTiling : &tiling);
+    Probe ballProbe("Ball", &ball);
+    Probe lightsProbe("LightMap", &lights);
+    Probe sparksProbe("Sparks", &sparks);
+    Probe* probes[] = { &tilingProbe, &ballProbe, &lightsProbe, &sparksProbe };
+
+    // the lights are spread over the screen, the first one in its center
+    for (uint8_t i = 0; i < lightCount; i++) {
+        lights.add(
+            SCREEN_WIDTH / 2 + (i * 37) % SCREEN_WIDTH - (i ? SCREEN_WIDTH / 2 : 0),
+            SCREEN_HEIGHT / 2 + (i * 23) % SCREEN_HEIGHT - (i ? SCREEN_HEIGHT / 2 : 0),
+            i ? 24 : 45,
+            i ? 160 : 255
+        );
+    }
+
+    DropShadow shadow(BALL_SHADOW_RADIUS, BALL_SHADOW_BLUR, BALL_SHADOW_STRENGTH);
+    ball.placeShadow(&shadow);
+    setUpTiling(tiling, lightCount ? &lights : NULL, dither, withShadow ? &shadow : NULL);
+    setUpTiling(brickTiling, lightCount ? &lights : NULL, dither, withShadow ? &shadow : NULL);
+
+    // the sparks are scattered by a linear congruential generator,
+    // so that their positions are the same from one run to the next
+    uint32_t seed = 1;
+    for (uint16_t i = 0; i < sparkCount; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int16_t x = (seed >> 8) % (SCREEN_WIDTH + 2) - 2;
+        seed = seed * 1103515245u + 12345u;
+        int16_t y = (seed >> 8) % (SCREEN_HEIGHT + 2) - 2;
+        sparks.add(x, y, i % 3);
+    }
+
+    #if TELEMETRY_ENABLED
+    FILE* stream = fopen("telemetry.bin", "wb");
+    if (stream == NULL) {
+        perror("telemetry.bin");
+        return 1;
+    }
+    SerialUSB.redirect(stream);
+    #endif
+
+    if (lightCount) Renderer::subscribe(&lightsProbe, -1);
+    Renderer::subscribe(&tilingProbe, 0);
+    Renderer::subscribe(&ballProbe, 1);
+    if (sparkCount) Renderer::subscribe(&sparksProbe, 2);
+
+    uint32_t slices = Renderer::getSliceCount();
+    uint64_t totalNs = 0;
+    uint32_t totalFrames = 0;
+    uint32_t hash = 2166136261u;
+    uint64_t ballChangesNs = 0;
+    uint32_t ballChangesCalls = 0;
+
+    printf("%8s %8s %12s %12s", "offsetX", "offsetY", "ns/frame", "ns/slice");
+    for (Probe* probe : probes) printf(" %12s", probe->name);
+    printf("\n");
+
+    for (int16_t oy = 0; oy < 32; oy += step) {
+        for (int16_t ox = 0; ox < 32; ox += step) {
+            if (bricks) brickTiling.setOffset(ox, oy);
+            else tiling.setOffset(ox, oy);
+            for (Probe* probe : probes) probe->reset();
+
+            Clock::time_point start = Clock::now();
+            // the whole screen is redrawn at each frame,
+            // otherwise the renderer would skip the unchanged slices
+            for (uint32_t f = 0; f < frames; f++) {
+                if (roll) ball.roll(ox + (f << BALL_ROLL_SHIFT), oy + ((f / BALL_ROLL_PHASES) << BALL_ROLL_SHIFT));
+                Renderer::invalidate();
+                Renderer::draw();
+                Telemetry::flush();
+            }
+            Renderer::flush();
+            uint64_t ns = elapsed(start);
+
+            totalNs += ns;
+            totalFrames += frames;
+            ballChangesNs += ballProbe.changesNs;
+            ballChangesCalls += ballProbe.changesCalls;
+            hash = (hash ^ checksum()) * 16777619u;
+
+            printf("%8d %8d %12llu %12llu", ox, oy,
+                (unsigned long long)(ns / frames),
+                (unsigned long long)(ns / (frames * slices)));
+            for (Probe* probe : probes) {
+                printf(" %12llu", (unsigned long long)(probe->calls ? probe->ns / probe->calls : 0));
+            }
+            printf("\n");
+        }
+    }
+
+    printf("\n%u frames, %llu ns/frame, %llu ns/slice, checksum %08x (%s shading)\n",
+        totalFrames,
+        (unsigned long long)(totalNs / totalFrames),
+        (unsigned long long)(totalNs / (totalFrames * slices)),
+        hash, kernels);
+    printf("%llu ns/frame to check the changes of the ball%s\n",
+        (unsigned long long)(ballChangesCalls ? ballChangesNs / ballChangesCalls : 0),
+        roll ? ", decoding a new frame each time" : "");
+
+    #if TELEMETRY_ENABLED
+    fclose(stream);
+    #endif
+
+    if (expectedChecksum && hash != strtoul(expectedChecksum, NULL, 16)) {
+        printf("the checksum should have been %s\n", expectedChecksum);
+        return 1;
+    }
+    return 0;
+}
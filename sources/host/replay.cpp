@@ -0,0 +1,371 @@
+// replays an input trace through the game engine, and checks or records
+// the frames received by the emulated display
+//
+// usage: replay <trace> [options]
+//   --record <golden>     -> writes the golden frames of the session
+//   --check <golden>      -> compares the session with its golden frames
+//   --raw <file>          -> dumps the screen after each frame (RGB565, SCREEN_WIDTH x SCREEN_HEIGHT)
+//   --slices <h> <n>      -> the height of the slices and the number of buffers
+//   --front-to-back       -> draws the observers from front to back
+//   --indexed             -> renders 8-bit indices in the slices
+//   --threads <n>         -> renders the slices of each frame over n threads
+//   --band <n>            -> the number of slices rendered by each task of the threads (default 1)
+//   --kernels <name>      -> the shading kernels of the tiling: auto (the fastest ones
+//                            supported by the CPU, by default), scalar, ssse3, avx2,
+//                            or reference for the rendering loop of the tiling itself
+//   --repeat <n>          -> replays the trace n times in a row (default 1)
+//   --map <file>          -> streams the tiling from a tile map instead of the checkerboard
+//   --reads <n>           -> checks that n chunks of the map are read during the session
+//   --lights <n>          -> lights the tiling with n lights of a light map instead of its halo
+//
+// the trace is made of the lines written by `InputTrace` on the console,
+// and the session runs on the virtual clock of the stub: each frame lasts
+// exactly one frame period, so that the replay is deterministic and runs
+// as fast as the host allows
+//
+// the map file holds a header line `<width> <height> <outside tile>`, followed
+// by one line of hexadecimal digits per row of tiles (one digit per tile),
+// and is streamed by a `FlashTileMap` as it would be from the flash memory
+//
+// the lights are spread over the screen as in the benchmark, the first one
+// in its center, and stay in place while the camera moves
+//
+// the golden file holds one line per frame: the CRC-32 of the whole screen,
+// followed by the row and the CRC-32 of each slice sent to the display...
+// the CRCs of the slices are only compared when the golden frames were
+// recorded with the same configuration of the renderer
+
+#include <Gamebuino-Meta.h>
+#include <chrono>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include "GameEngine.h"
+#include "TileMap.h"
+#include "LightMap.h"
+#include "Renderer.h"
+#include "ParallelRenderer.h"
+#include "VectorKernels.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// a run of frames during which the same buttons are held down
+struct Run
+{
+    uint32_t frames;
+    uint8_t mask;
+};
+
+// the CRC-32 (IEEE 802.3) is computed 8 bytes at a time, with 8 tables
+// (the "slicing-by-8" method), so that checking the frames costs little
+static uint32_t crcTables[8][256];
+
+static void initCrc() {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (uint8_t k = 0; k < 8; k++) c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+        crcTables[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (uint8_t t = 1; t < 8; t++) {
+            crcTables[t][i] = crcTables[0][crcTables[t - 1][i] & 0xff] ^ (crcTables[t - 1][i] >> 8);
+        }
+    }
+}
+
+static uint32_t crc32(const uint16_t* pixels, uint32_t n) {
+    uint32_t c = 0xffffffff;
+    const uint8_t* bytes = (const uint8_t*)pixels;
+    uint32_t size = n * sizeof(uint16_t);
+    // the bytes are read in the order of the memory (little-endian host)
+    for (; size >= 8; size -= 8, bytes += 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, bytes, 4);
+        memcpy(&hi, bytes + 4, 4);
+        lo ^= c;
+        c = crcTables[7][lo & 0xff] ^ crcTables[6][(lo >> 8) & 0xff] ^ crcTables[5][(lo >> 16) & 0xff] ^ crcTables[4][lo >> 24]
+          ^ crcTables[3][hi & 0xff] ^ crcTables[2][(hi >> 8) & 0xff] ^ crcTables[1][(hi >> 16) & 0xff] ^ crcTables[0][hi >> 24];
+    }
+    for (; size; size--, bytes++) c = crcTables[0][(c ^ *bytes) & 0xff] ^ (c >> 8);
+    return c ^ 0xffffffff;
+}
+
+// the line of the golden file of the current frame
+static std::string frameLine;
+
+// each buffer received by the display is a slice (or a part of it)
+static void capture(int16_t, int16_t y0, int16_t, int16_t, const uint16_t* buffer, uint16_t n) {
+    char token[24];
+    snprintf(token, sizeof(token), " %d:%08x", y0, crc32(buffer, n));
+    frameLine += token;
+}
+
+static bool readTrace(const char* path, std::vector<Run>& runs) {
+    FILE* input = fopen(path, "r");
+    if (input == NULL) {
+        perror(path);
+        return false;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), input)) {
+        if (line[0] == '#') continue;
+        Run run;
+        unsigned mask;
+        if (sscanf(line, "%u %x", &run.frames, &mask) == 2) {
+            run.mask = mask;
+            runs.push_back(run);
+        }
+    }
+    fclose(input);
+    return true;
+}
+
+static FlashTileMap* readMap(const char* path, std::vector<uint8_t>& tiles) {
+    FILE* input = fopen(path, "r");
+    if (input == NULL) {
+        perror(path);
+        return NULL;
+    }
+    char line[1024];
+    unsigned width = 0, height = 0, outside = 0;
+    bool header = false;
+    while (fgets(line, sizeof(line), input)) {
+        if (line[0] == '#') continue;
+        if (!header) {
+            header = sscanf(line, "%u %u %x", &width, &height, &outside) == 3;
+            continue;
+        }
+        for (unsigned x = 0; x < width && isxdigit(line[x]); x++) {
+            tiles.push_back(isdigit(line[x]) ? line[x] - '0' : tolower(line[x]) - 'a' + 10);
+        }
+    }
+    fclose(input);
+    if (!header || width == 0 || width > 0xffff || height > 0xffff || tiles.size() != width * height) {
+        fprintf(stderr, "%s: %zu tiles read, %u x %u expected\n", path, tiles.size(), width, height);
+        return NULL;
+    }
+    return new FlashTileMap(tiles.data(), width, height, outside);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <trace> [--record <golden>] [--check <golden>] [--raw <file>] [--slices <h> <n>] [--front-to-back] [--indexed] [--threads <n>] [--band <n>] [--kernels <name>] [--repeat <n>] [--map <file>] [--reads <n>] [--lights <n>]\n", argv[0]);
+        return 1;
+    }
+
+    const char* tracePath = argv[1];
+    const char* recordPath = NULL;
+    const char* checkPath = NULL;
+    const char* rawPath = NULL;
+    uint8_t sliceHeight = DEFAULT_SLICE_HEIGHT;
+    uint8_t buffers = DEFAULT_BUFFER_COUNT;
+    bool frontToBack = false;
+    bool indexed = false;
+    unsigned threads = 0;
+    uint8_t band = 1;
+    const char* kernels = "auto";
+    uint32_t repeat = 1;
+    const char* mapPath = NULL;
+    int64_t expectedReads = -1;
+    uint8_t lightCount = 0;
+
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "--record") && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (!strcmp(argv[i], "--check") && i + 1 < argc) {
+            checkPath = argv[++i];
+        } else if (!strcmp(argv[i], "--raw") && i + 1 < argc) {
+            rawPath = argv[++i];
+        } else if (!strcmp(argv[i], "--slices") && i + 2 < argc) {
+            sliceHeight = atoi(argv[++i]);
+            buffers = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--front-to-back")) {
+            frontToBack = true;
+        } else if (!strcmp(argv[i], "--indexed")) {
+            indexed = true;
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--band") && i + 1 < argc) {
+            band = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--kernels") && i + 1 < argc) {
+            kernels = argv[++i];
+        } else if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--map") && i + 1 < argc) {
+            mapPath = argv[++i];
+        } else if (!strcmp(argv[i], "--reads") && i + 1 < argc) {
+            expectedReads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--lights") && i + 1 < argc) {
+            lightCount = atoi(argv[++i]);
+            if (lightCount > MAX_LIGHTS) lightCount = MAX_LIGHTS;
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<Run> runs;
+    if (!readTrace(tracePath, runs)) return 1;
+
+    std::vector<uint8_t> mapTiles;
+    FlashTileMap* map = NULL;
+    if (mapPath) {
+        map = readMap(mapPath, mapTiles);
+        if (map == NULL) return 1;
+    }
+
+    // the kernels unsupported by the CPU are reported with the exit code
+    // which tells ctest to skip the test
+    if (strcmp(kernels, "reference")) {
+        ShadingKernels* selected = VectorKernels::get(kernels);
+        if (selected == NULL) {
+            fprintf(stderr, "the %s shading kernels are not available on this host\n", kernels);
+            return 77;
+        }
+        ShadingKernels::install(selected);
+    }
+
+    if (!Renderer::configure(sliceHeight, buffers, indexed)) {
+        fprintf(stderr, "%u buffers of %u rows do not fit in the arena of the renderer\n", buffers, sliceHeight);
+        return 1;
+    }
+    Renderer::setFrontToBack(frontToBack);
+
+    // the frames are rendered by the same observers, only spread over several threads
+    std::unique_ptr<ParallelRenderer> parallel;
+    if (threads) {
+        parallel.reset(new ParallelRenderer(threads, band));
+        Renderer::setBackend(parallel.get());
+    }
+
+    // the configuration of the renderer is written in the header of the golden file
+    char config[64];
+    snprintf(config, sizeof(config), "# slices %ux%u %s%s", sliceHeight, buffers, frontToBack ? "front-to-back" : "painter", indexed ? " indexed" : "");
+
+    FILE* record = NULL;
+    if (recordPath) {
+        record = fopen(recordPath, "w");
+        if (record == NULL) {
+            perror(recordPath);
+            return 1;
+        }
+        const char* traceName = strrchr(tracePath, '/');
+        fprintf(record, "# golden frames of %s: <screen CRC> [<row>:<slice CRC>...]\n%s\n", traceName ? traceName + 1 : tracePath, config);
+    }
+
+    FILE* check = NULL;
+    bool checkSlices = false;
+    char expected[4096];
+    if (checkPath) {
+        check = fopen(checkPath, "r");
+        if (check == NULL) {
+            perror(checkPath);
+            return 1;
+        }
+        // the CRCs of the slices are only relevant with the same configuration
+        while (fgets(expected, sizeof(expected), check) && expected[0] == '#') {
+            expected[strcspn(expected, "\n")] = 0;
+            if (!strcmp(expected, config)) checkSlices = true;
+        }
+    }
+
+    FILE* raw = NULL;
+    if (rawPath) {
+        raw = fopen(rawPath, "wb");
+        if (raw == NULL) {
+            perror(rawPath);
+            return 1;
+        }
+    }
+
+    initCrc();
+    useVirtualClock(true);
+    gb.tft.capture = capture;
+    GameEngine::init();
+    if (map) GameEngine::setMap(map);
+
+    LightMap lights;
+    for (uint8_t i = 0; i < lightCount; i++) {
+        lights.add(
+            SCREEN_WIDTH / 2 + (i * 37) % SCREEN_WIDTH - (i ? SCREEN_WIDTH / 2 : 0),
+            SCREEN_HEIGHT / 2 + (i * 23) % SCREEN_HEIGHT - (i ? SCREEN_HEIGHT / 2 : 0),
+            i ? 24 : 45,
+            i ? 160 : 255
+        );
+    }
+    if (lightCount) GameEngine::setLightMap(&lights);
+
+    uint32_t frame = 0;
+    uint32_t mismatches = 0;
+    Clock::time_point start = Clock::now();
+
+    for (uint32_t r = 0; r < repeat; r++) {
+        for (const Run& run : runs) {
+            for (uint32_t f = 0; f < run.frames; f++, frame++) {
+                gb.buttons.set(run.mask);
+                gb.update();
+                frameLine.clear();
+                GameEngine::tick();
+                // the frame is only complete once all its slices have been sent
+                Renderer::flush();
+
+                char screen[16];
+                snprintf(screen, sizeof(screen), "%08x", crc32(gb.tft.framebuffer, ST7735_TFTWIDTH * ST7735_TFTHEIGHT));
+                std::string line = screen + frameLine;
+
+                if (record) fprintf(record, "%s\n", line.c_str());
+                if (raw) fwrite(gb.tft.framebuffer, sizeof(gb.tft.framebuffer), 1, raw);
+
+                if (check) {
+                    if (frame > 0 && !fgets(expected, sizeof(expected), check)) {
+                        fprintf(stderr, "frame %u: no more golden frames\n", frame);
+                        return 1;
+                    }
+                    expected[strcspn(expected, "\n")] = 0;
+                    bool same = checkSlices ? line == expected : line.compare(0, 8, expected, 8) == 0;
+                    if (!same) {
+                        if (mismatches++ < 10) {
+                            fprintf(stderr, "frame %u differs:\n  expected %s\n  got      %s\n", frame, expected, line.c_str());
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // the golden file must not hold more frames than the session
+    bool leftover = check && fgets(expected, sizeof(expected), check);
+
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    printf("%u frames in %.3f s (%.0f frames/s, %.1fx real time)\n",
+        frame, ns / 1e9, frame * 1e9 / ns, frame * 40e6 / ns);
+
+    // the chunks are only read when they enter the window of the cache
+    uint32_t reads = GameEngine::getChunkReadCount();
+    printf("%u chunks read from the map\n", reads);
+    delete map;
+
+    if (record) fclose(record);
+    if (raw) fclose(raw);
+    if (expectedReads >= 0 && reads != expectedReads) {
+        printf("%lld chunks should have been read\n", (long long)expectedReads);
+        return 1;
+    }
+    if (check) {
+        fclose(check);
+        if (mismatches) {
+            printf("%u frames differ from the golden frames\n", mismatches);
+            return 1;
+        }
+        if (leftover) {
+            printf("the golden file holds more than %u frames\n", frame);
+            return 1;
+        }
+        printf("all the frames match the golden frames%s\n", checkSlices ? " (screen and slices)" : " (screen)");
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include "Gamebuino-Meta.h"
+#include <stdarg.h>
+#include <chrono>
+
+// the emulated hardware
+SPIClass SPI;
+SerialUSBClass SerialUSB;
+Gamebuino_Meta::Gamebuino gb;
+
+// the reference instant from which the time is measured
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+// the virtual clock, when it is used
+static bool virtualClock = false;
+static uint32_t virtualMicros = 0;
+
+uint32_t millis() {
+    if (virtualClock) return virtualMicros / 1000;
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+uint32_t micros() {
+    if (virtualClock) return virtualMicros;
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void useVirtualClock(bool enabled) {
+    virtualClock = enabled;
+    virtualMicros = 0;
+}
+
+void SPIClass::beginTransaction(SPISettings) {}
+void SPIClass::endTransaction() {}
+
+SerialUSBClass::SerialUSBClass() : output(NULL) {}
+
+void SerialUSBClass::redirect(FILE* output) {
+    this->output = output;
+}
+
+void SerialUSBClass::begin(uint32_t) {}
+
+int SerialUSBClass::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vfprintf(this->output ? this->output : stdout, format, args);
+    va_end(args);
+    return n;
+}
+
+size_t SerialUSBClass::write(const uint8_t* buffer, size_t size) {
+    return fwrite(buffer, 1, size, this->output ? this->output : stdout);
+}
+
+namespace Gamebuino_Meta {
+
+    // the DMA controller of the SAMD21 has 3 descriptors,
+    // and they are all available since the transfers are immediate
+    volatile uint32_t dma_desc_free_count = 3;
+
+    Display_ST7735::Display_ST7735() : x0(0), y0(0), x1(0), y1(0), cx(0), cy(0), pixelCount(0), capture(NULL) {
+        memset(this->framebuffer, 0, sizeof(this->framebuffer));
+    }
+
+    void Display_ST7735::setAddrWindow(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+        this->x0 = x0;
+        this->y0 = y0;
+        this->x1 = x1;
+        this->y1 = y1;
+        this->cx = x0;
+        this->cy = y0;
+    }
+
+    void Display_ST7735::dataMode() {}
+    void Display_ST7735::idleMode() {}
+
+    void Display_ST7735::sendBuffer(uint16_t* buffer, uint16_t n) {
+        this->pixelCount += n;
+        if (this->capture) this->capture(this->x0, this->y0, this->x1, this->y1, buffer, n);
+        while (n) {
+            // the pixels are copied up to the end of the current row of the window
+            uint16_t run = this->x1 - this->cx + 1;
+            if (run > n) run = n;
+            // the pixels which fall outside the panel are lost, as on the real hardware
+            if (this->cy >= 0 && this->cy < ST7735_TFTHEIGHT) {
+                int16_t from = this->cx < 0 ? 0 : this->cx;
+                int16_t to = this->cx + run > ST7735_TFTWIDTH ? ST7735_TFTWIDTH : this->cx + run;
+                if (from < to) {
+                    memcpy(this->framebuffer + from + this->cy * ST7735_TFTWIDTH, buffer + from - this->cx, (to - from) * sizeof(uint16_t));
+                }
+            }
+            buffer += run;
+            n -= run;
+            this->cx += run;
+            // the controller wraps to the next row of the address window
+            if (this->cx > this->x1) {
+                this->cx = this->x0;
+                if (++this->cy > this->y1) this->cy = this->y0;
+            }
+        }
+    }
+
+    void Image::init(uint16_t, uint16_t, ColorMode) {}
+
+    // the states follow the conventions of the official library:
+    //   0      -> the button is released
+    //   0xffff -> the button has just been released
+    //   n      -> the button has been held down for n frames
+    Buttons::Buttons() : down(0) {
+        memset(this->states, 0, sizeof(this->states));
+    }
+
+    void Buttons::press(Button button) {
+        this->down |= 1 << (uint8_t)button;
+    }
+
+    void Buttons::release(Button button) {
+        this->down &= ~(1 << (uint8_t)button);
+    }
+
+    void Buttons::set(uint8_t mask) {
+        this->down = mask;
+    }
+
+    void Buttons::update() {
+        for (uint8_t i = 0; i < 8; i++) {
+            uint16_t& state = this->states[i];
+            if (this->down & (1 << i)) {
+                if (state == 0xffff) state = 0;
+                if (state < 0xfffe) state++;
+            } else {
+                state = (state == 0 || state == 0xffff) ? 0 : 0xffff;
+            }
+        }
+    }
+
+    bool Buttons::pressed(Button button) {
+        return this->states[(uint8_t)button] == 1;
+    }
+
+    bool Buttons::released(Button button) {
+        return this->states[(uint8_t)button] == 0xffff;
+    }
+
+    bool Buttons::held(Button button, uint16_t time) {
+        return this->states[(uint8_t)button] == time + 1;
+    }
+
+    bool Buttons::repeat(Button button, uint16_t period) {
+        uint16_t state = this->states[(uint8_t)button];
+        if (state == 0 || state == 0xffff) return false;
+        return period <= 1 || (state % period) == 1;
+    }
+
+    Gamebuino::Gamebuino() : frameRate(25), frameCount(0) {}
+
+    void Gamebuino::begin() {}
+
+    // there is no frame pacing on the host: a new frame is always due...
+    // with the virtual clock, exactly one frame period has elapsed
+    bool Gamebuino::update() {
+        if (virtualClock) virtualMicros += 1000000 / this->frameRate;
+        this->buttons.update();
+        this->frameCount++;
+        return true;
+    }
+
+    void Gamebuino::setFrameRate(uint8_t fps) {
+        if (fps) this->frameRate = fps;
+    }
+
+    uint8_t Gamebuino::getCpuLoad() {
+        return 0;
+    }
+
+    uint16_t Gamebuino::getFreeRam() {
+        return 0;
+    }
+
+};
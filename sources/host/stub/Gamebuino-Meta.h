@@ -0,0 +1,212 @@
+#ifndef SHADING_EFFECT_HOST_GAMEBUINO_META
+#define SHADING_EFFECT_HOST_GAMEBUINO_META
+
+// this header replaces the official Gamebuino META library
+// when the sketch is compiled on the host (Linux) machine...
+// it only declares what the sketch actually uses,
+// and the display is emulated by a simple framebuffer
+// in which the slices sent to the "DMA controller" are copied
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// the native width and height of the ST7735 panel... the emulated panel
+// takes the geometry the sketch is compiled for, if it is given to the compiler
+#ifdef SCREEN_WIDTH
+#define ST7735_TFTWIDTH  SCREEN_WIDTH
+#define ST7735_TFTHEIGHT SCREEN_HEIGHT
+#else
+#define ST7735_TFTWIDTH  160
+#define ST7735_TFTHEIGHT 128
+#endif
+
+// the SPI settings are simply stored, they have no effect on the host
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+class SPISettings
+{
+    public:
+
+        SPISettings() : clock(0), bitOrder(MSBFIRST), dataMode(SPI_MODE0) {}
+        SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode)
+            : clock(clock), bitOrder(bitOrder), dataMode(dataMode) {}
+
+        uint32_t clock;
+        uint8_t bitOrder;
+        uint8_t dataMode;
+};
+
+class SPIClass
+{
+    public:
+
+        void beginTransaction(SPISettings settings);
+        void endTransaction();
+};
+
+extern SPIClass SPI;
+
+// the serial port is redirected to the standard output
+class SerialUSBClass
+{
+    private:
+
+        FILE* output;
+
+    public:
+
+        SerialUSBClass();
+
+        // host only: redirects the serial port to another stream
+        void redirect(FILE* output);
+
+        void begin(uint32_t baudrate);
+        int printf(const char* format, ...);
+        size_t write(const uint8_t* buffer, size_t size);
+};
+
+extern SerialUSBClass SerialUSB;
+
+// the time elapsed since the program was started
+uint32_t millis();
+uint32_t micros();
+
+// host only: the time is no longer read from the clock of the host,
+// but advanced by `gb.update()` by one frame period at each frame...
+// the replays of an input trace are then deterministic, and as fast as possible
+void useVirtualClock(bool enabled);
+
+namespace Gamebuino_Meta {
+
+    // the number of free DMA descriptors...
+    // the transfers are instantaneous on the host,
+    // so that all the descriptors are always available
+    extern volatile uint32_t dma_desc_free_count;
+
+    enum class ColorMode : uint8_t {
+        index,
+        rgb565
+    };
+
+    enum class Button : uint8_t {
+        down,
+        left,
+        right,
+        up,
+        a,
+        b,
+        menu,
+        home
+    };
+
+    // the emulated display controller
+    class Display_ST7735
+    {
+        private:
+
+            // the address window defined by `setAddrWindow()`
+            int16_t x0,y0,x1,y1;
+            // the position of the next pixel to be written in the window
+            int16_t cx,cy;
+
+        public:
+
+            // the emulated screen
+            uint16_t framebuffer[ST7735_TFTWIDTH * ST7735_TFTHEIGHT];
+            // the number of pixels received since the program was started
+            uint32_t pixelCount;
+
+            // host only: a function called with each buffer received,
+            // and the address window it is sent to
+            typedef void (*Capture)(int16_t x0, int16_t y0, int16_t x1, int16_t y1, const uint16_t* buffer, uint16_t n);
+            Capture capture;
+
+            Display_ST7735();
+
+            void setAddrWindow(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+            void dataMode();
+            void idleMode();
+            // the pixels are copied in the address window, row by row
+            void sendBuffer(uint16_t* buffer, uint16_t n);
+    };
+
+    class Image
+    {
+        public:
+
+            void init(uint16_t w, uint16_t h, ColorMode col);
+    };
+
+    class Buttons
+    {
+        private:
+
+            // the buttons currently held down by the host program (one bit per button)
+            uint8_t down;
+
+        public:
+
+            // the number of frames during which each button has been held down
+            // (public, as in the official library)
+            uint16_t states[8];
+
+            Buttons();
+
+            // the buttons are driven by the host program:
+            // `press()` holds a button down until `release()` is called,
+            // and `set()` holds down exactly the buttons of a mask
+            void press(Button button);
+            void release(Button button);
+            void set(uint8_t mask);
+            // samples the buttons, called once per frame by `gb.update()`
+            void update();
+
+            bool pressed(Button button);
+            bool released(Button button);
+            bool held(Button button, uint16_t time);
+            bool repeat(Button button, uint16_t period);
+    };
+
+    class Gamebuino
+    {
+        private:
+
+            // the frame rate set by `setFrameRate()`
+            uint8_t frameRate;
+
+        public:
+
+            Display_ST7735 tft;
+            Image display;
+            Buttons buttons;
+            uint32_t frameCount;
+
+            Gamebuino();
+
+            void begin();
+            bool update();
+            void setFrameRate(uint8_t fps);
+            uint8_t getCpuLoad();
+            uint16_t getFreeRam();
+    };
+
+};
+
+using Gamebuino_Meta::ColorMode;
+using Gamebuino_Meta::Button;
+
+#define BUTTON_DOWN  Button::down
+#define BUTTON_LEFT  Button::left
+#define BUTTON_RIGHT Button::right
+#define BUTTON_UP    Button::up
+#define BUTTON_A     Button::a
+#define BUTTON_B     Button::b
+#define BUTTON_MENU  Button::menu
+#define BUTTON_HOME  Button::home
+
+extern Gamebuino_Meta::Gamebuino gb;
+
+#endif
@@ -0,0 +1,98 @@
+// indexes a RGB888 spritesheet for the shaded palettes (see `Palette.h`)
+//
+// usage: img2shading <class> <width> <height> [transparent color] < spritesheet.txt
+//
+// the spritesheet is read on the standard input in the form of hexadecimal
+// color codes (0xcccccc, 0xaaaaaa, ...), row after row... the transparent
+// color is 0x000000 by default
+//
+// the colors are numbered in the order in which they appear, after the
+// transparent color which always gets the index 0, and the tool writes
+// on the standard output:
+//   const uint8_t <class>::BITMAP[]   -> the index of each pixel
+//   the list of the reference colors  -> the parameters of the `PaletteShader`
+//                                        from which the compiler computes the
+//                                        shaded palette
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <vector>
+#include <algorithm>
+
+// reads all the hexadecimal numbers of the standard input
+static std::vector<uint32_t> readPixels() {
+    std::vector<uint32_t> pixels;
+    int c, previous = 0;
+    while ((c = getchar()) != EOF) {
+        if (previous == '0' && (c == 'x' || c == 'X')) {
+            uint32_t value = 0;
+            while ((c = getchar()) != EOF && isxdigit(c)) {
+                value = (value << 4) | (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+            }
+            pixels.push_back(value);
+        }
+        previous = c;
+    }
+    return pixels;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <class> <width> <height> [transparent color] < spritesheet.txt\n", argv[0]);
+        return 1;
+    }
+
+    const char* name = argv[1];
+    int width = atoi(argv[2]);
+    int height = atoi(argv[3]);
+    uint32_t transparent = argc > 4 ? strtoul(argv[4], NULL, 0) : 0x000000;
+
+    if (width <= 0 || height <= 0) {
+        fprintf(stderr, "the dimensions of the spritesheet must be positive\n");
+        return 1;
+    }
+
+    std::vector<uint32_t> pixels = readPixels();
+    if (pixels.size() != (size_t)(width * height)) {
+        fprintf(stderr, "%zu pixels read, %d expected\n", pixels.size(), width * height);
+        return 1;
+    }
+
+    // the index 0 is reserved for the transparent color
+    std::vector<uint32_t> colors(1, transparent);
+    std::vector<uint8_t> bitmap;
+    for (uint32_t pixel : pixels) {
+        std::vector<uint32_t>::iterator it = std::find(colors.begin(), colors.end(), pixel);
+        if (it == colors.end()) {
+            if (colors.size() == 256) {
+                fprintf(stderr, "the spritesheet has more than 255 colors\n");
+                return 1;
+            }
+            it = colors.insert(colors.end(), pixel);
+        }
+        bitmap.push_back(it - colors.begin());
+    }
+
+    printf("// the spritesheet indexed by the `img2shading` tool:\n");
+    printf("// %zu reference colors\n", colors.size() - 1);
+    printf("const uint8_t %s::BITMAP[] = {\n", name);
+    for (int y = 0; y < height; y++) {
+        printf("    ");
+        for (int x = 0; x < width; x++) {
+            printf("%u", bitmap[x + y * width]);
+            if (x + 1 < width || y + 1 < height) printf(",");
+            printf(x + 1 < width ? " " : "\n");
+        }
+    }
+    printf("};\n\n");
+
+    printf("// the reference colors, to be given to the `PaletteShader`:\n");
+    printf("// ");
+    for (size_t i = 1; i < colors.size(); i++) {
+        printf("0x%06x%s", colors[i], i + 1 < colors.size() ? ", " : "\n");
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+// compresses the frames of an animated RGB565 sprite into runs of palette codes
+// (see `Ball.h`)
+//
+// usage: sprite2rle <class> <width> <height> <frames> <transparent color> <colors...> < frames.txt
+//
+// the frames are read on the standard input in the form of the hexadecimal
+// color codes provided by the img2tft transcoding tool (0xf81f, 0x07e0, ...),
+// row after row, frame after frame... each pixel is given the code of its
+// color in the list of colors, from 1 (the code 0 is the transparent color),
+// so that the list can be the one of the sprite in the screen palette
+//
+// each row of a frame is cut into runs of pixels of the same code, each one
+// being stored in a single byte: the code in the 3 upper bits, and the length
+// minus 1 in the 5 lower bits (a run never straddles two rows)
+//
+// the tables are written on the standard output, ready to be
+// pasted in the source file of the class, along with the size of
+// the buffers in which a frame is decoded into runs of opaque pixels
+// (the consecutive runs of opaque pixels of a row make a single span):
+//   const uint8_t <class>::FRAME_RUNS[]
+//   const uint16_t <class>::FRAME_OFFSETS[]
+//   const uint8_t <class>::FRAME_MAX_SPANS   (the largest number of spans of a frame)
+//   const uint16_t <class>::FRAME_MAX_PIXELS (the largest number of opaque pixels of a frame)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <vector>
+
+// the longest run, and the largest number of colors
+#define MAX_RUN 32
+#define MAX_COLORS 7
+
+// reads all the hexadecimal numbers of the standard input
+static std::vector<uint16_t> readPixels() {
+    std::vector<uint16_t> pixels;
+    int c, previous = 0;
+    while ((c = getchar()) != EOF) {
+        if (previous == '0' && (c == 'x' || c == 'X')) {
+            unsigned value = 0;
+            while ((c = getchar()) != EOF && isxdigit(c)) {
+                value = (value << 4) | (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+            }
+            pixels.push_back(value);
+        }
+        previous = c;
+    }
+    return pixels;
+}
+
+// writes the values of a table, 16 per line
+template <typename T, typename F>
+static void writeTable(const std::vector<T>& values, F write) {
+    for (size_t i = 0; i < values.size(); i++) {
+        if (i % 16 == 0) printf("    ");
+        write(values[i]);
+        if (i + 1 < values.size()) printf(",");
+        printf(i % 16 == 15 || i + 1 == values.size() ? "\n" : " ");
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 7) {
+        fprintf(stderr, "usage: %s <class> <width> <height> <frames> <transparent color> <colors...> < frames.txt\n", argv[0]);
+        return 1;
+    }
+
+    const char* name = argv[1];
+    int width = atoi(argv[2]);
+    int height = atoi(argv[3]);
+    int frames = atoi(argv[4]);
+    uint16_t transparent = strtoul(argv[5], NULL, 0);
+    std::vector<uint16_t> colors;
+    for (int i = 6; i < argc; i++) colors.push_back(strtoul(argv[i], NULL, 0));
+
+    if (width <= 0 || width > 255 || height <= 0 || height > 255 || frames <= 0) {
+        fprintf(stderr, "the dimensions of the sprite must be between 1 and 255\n");
+        return 1;
+    }
+    if (colors.size() > MAX_COLORS) {
+        fprintf(stderr, "a sprite has at most %d colors\n", MAX_COLORS);
+        return 1;
+    }
+
+    std::vector<uint16_t> bitmap = readPixels();
+    if (bitmap.size() != (size_t)(width * height * frames)) {
+        fprintf(stderr, "%zu pixels read, %d expected\n", bitmap.size(), width * height * frames);
+        return 1;
+    }
+
+    // the code of each pixel
+    std::vector<uint8_t> codes;
+    for (uint16_t pixel : bitmap) {
+        if (pixel == transparent) {
+            codes.push_back(0);
+            continue;
+        }
+        size_t i = 0;
+        while (i < colors.size() && colors[i] != pixel) i++;
+        if (i == colors.size()) {
+            fprintf(stderr, "the color 0x%04x is not in the list\n", pixel);
+            return 1;
+        }
+        codes.push_back(i + 1);
+    }
+
+    std::vector<uint8_t> runs;
+    std::vector<uint16_t> offsets;
+    int maxSpans = 0;
+    int maxPixels = 0;
+    for (int f = 0; f < frames; f++) {
+        offsets.push_back(runs.size());
+        int spans = 0;
+        int pixels = 0;
+        for (int y = 0; y < height; y++) {
+            const uint8_t* row = codes.data() + (f * height + y) * width;
+            int x = 0;
+            while (x < width) {
+                int length = 1;
+                while (x + length < width && length < MAX_RUN && row[x + length] == row[x]) length++;
+                runs.push_back((row[x] << 5) | (length - 1));
+                // a span starts at each opaque pixel which follows a transparent one
+                if (row[x] && (x == 0 || !row[x - 1])) spans++;
+                if (row[x]) pixels += length;
+                x += length;
+            }
+        }
+        if (spans > maxSpans) maxSpans = spans;
+        if (pixels > maxPixels) maxPixels = pixels;
+    }
+    offsets.push_back(runs.size());
+
+    if (maxSpans > 255) {
+        fprintf(stderr, "a frame has %d spans, at most 255 can be decoded\n", maxSpans);
+        return 1;
+    }
+
+    printf("// the frames compressed by the `sprite2rle` tool:\n");
+    printf("// %zu bytes of runs for %d frames of %d pixels\n", runs.size(), frames, width * height);
+    printf("const uint8_t %s::FRAME_RUNS[] = {\n", name);
+    writeTable(runs, [](uint8_t v) { printf("0x%02x", v); });
+    printf("};\n\n");
+    printf("const uint16_t %s::FRAME_OFFSETS[] = {\n", name);
+    writeTable(offsets, [](uint16_t v) { printf("%u", v); });
+    printf("};\n\n");
+    printf("// the buffers in which a frame is decoded\n");
+    printf("const uint8_t %s::FRAME_MAX_SPANS = %d;\n", name, maxSpans);
+    printf("const uint16_t %s::FRAME_MAX_PIXELS = %d;\n", name, maxPixels);
+
+    return 0;
+}
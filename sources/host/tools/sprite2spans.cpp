@@ -0,0 +1,140 @@
+// compiles a RGB565 sprite into runs of opaque pixels (see `Sprite.h`)
+//
+// usage: sprite2spans <class> <width> <height> [transparent color] [palette index] < sprite.txt
+//
+// the sprite is read on the standard input in the form of the hexadecimal
+// color codes provided by the img2tft transcoding tool (0xf81f, 0x07e0, ...),
+// row after row... the transparent color is 0xffff by default
+//
+// the colors of the sprite are numbered in their order of appearance from the
+// given position of the screen palette (see `ScreenPalette.h`), for the indexed
+// mode of the renderer... the list of these colors is written as well
+//
+// the tables are written on the standard output, ready to be
+// pasted in the source file of the class:
+//   const uint16_t <class>::SPRITE_ROWS[]
+//   const SpriteSpan <class>::SPRITE_SPANS[]
+//   const uint16_t <class>::SPRITE_PIXELS[]
+//   const uint8_t <class>::SPRITE_INDICES[]
+//   const Sprite <class>::SPRITE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <vector>
+
+struct Span
+{
+    int x, length, pixel;
+};
+
+// reads all the hexadecimal numbers of the standard input
+static std::vector<uint16_t> readPixels() {
+    std::vector<uint16_t> pixels;
+    int c, previous = 0;
+    while ((c = getchar()) != EOF) {
+        if (previous == '0' && (c == 'x' || c == 'X')) {
+            unsigned value = 0;
+            while ((c = getchar()) != EOF && isxdigit(c)) {
+                value = (value << 4) | (isdigit(c) ? c - '0' : (tolower(c) - 'a' + 10));
+            }
+            pixels.push_back(value);
+        }
+        previous = c;
+    }
+    return pixels;
+}
+
+// writes the values of a table, 16 per line
+template <typename T, typename F>
+static void writeTable(const std::vector<T>& values, F write) {
+    for (size_t i = 0; i < values.size(); i++) {
+        if (i % 16 == 0) printf("    ");
+        write(values[i]);
+        if (i + 1 < values.size()) printf(",");
+        printf(i % 16 == 15 || i + 1 == values.size() ? "\n" : " ");
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <class> <width> <height> [transparent color] [palette index] < sprite.txt\n", argv[0]);
+        return 1;
+    }
+
+    const char* name = argv[1];
+    int width = atoi(argv[2]);
+    int height = atoi(argv[3]);
+    uint16_t transparent = argc > 4 ? strtoul(argv[4], NULL, 0) : 0xffff;
+    int paletteIndex = argc > 5 ? atoi(argv[5]) : 0;
+
+    if (width <= 0 || width > 255 || height <= 0 || height > 255) {
+        fprintf(stderr, "the dimensions of the sprite must be between 1 and 255\n");
+        return 1;
+    }
+
+    std::vector<uint16_t> bitmap = readPixels();
+    if (bitmap.size() != (size_t)(width * height)) {
+        fprintf(stderr, "%zu pixels read, %d expected\n", bitmap.size(), width * height);
+        return 1;
+    }
+
+    std::vector<uint16_t> rows;
+    std::vector<Span> spans;
+    std::vector<uint16_t> pixels;
+
+    for (int y = 0; y < height; y++) {
+        rows.push_back(spans.size());
+        int x = 0;
+        while (x < width) {
+            // the transparent pixels are skipped...
+            while (x < width && bitmap[x + y * width] == transparent) x++;
+            if (x == width) break;
+            // and the opaque ones are gathered in a span
+            Span span = { x, 0, (int)pixels.size() };
+            while (x < width && bitmap[x + y * width] != transparent) {
+                pixels.push_back(bitmap[x + y * width]);
+                span.length++;
+                x++;
+            }
+            spans.push_back(span);
+        }
+    }
+    rows.push_back(spans.size());
+
+    // the colors of the sprite, and the index of each opaque pixel
+    std::vector<uint16_t> colors;
+    std::vector<uint16_t> indices;
+    for (uint16_t pixel : pixels) {
+        size_t i = 0;
+        while (i < colors.size() && colors[i] != pixel) i++;
+        if (i == colors.size()) colors.push_back(pixel);
+        indices.push_back(paletteIndex + i);
+    }
+    if (paletteIndex + colors.size() > 256) {
+        fprintf(stderr, "the %zu colors of the sprite overflow the screen palette\n", colors.size());
+        return 1;
+    }
+
+    printf("// the sprite compiled by the `sprite2spans` tool:\n");
+    printf("// %d opaque pixels out of %d, in %zu spans\n", (int)pixels.size(), width * height, spans.size());
+    printf("const uint16_t %s::SPRITE_ROWS[] = {\n", name);
+    writeTable(rows, [](uint16_t v) { printf("%u", v); });
+    printf("};\n\n");
+    printf("const SpriteSpan %s::SPRITE_SPANS[] = {\n", name);
+    writeTable(spans, [](const Span& s) { printf("{ %d, %d, %d }", s.x, s.length, s.pixel); });
+    printf("};\n\n");
+    printf("const uint16_t %s::SPRITE_PIXELS[] = {\n", name);
+    writeTable(pixels, [](uint16_t v) { printf("0x%04x", v); });
+    printf("};\n\n");
+    printf("// the %zu colors of the sprite, from the position %d of the screen palette:\n// ", colors.size(), paletteIndex);
+    for (uint16_t color : colors) printf(" 0x%04x", color);
+    printf("\n");
+    printf("const uint8_t %s::SPRITE_INDICES[] = {\n", name);
+    writeTable(indices, [](uint16_t v) { printf("%u", v); });
+    printf("};\n\n");
+    printf("const Sprite %s::SPRITE = { %d, %d, SPRITE_ROWS, SPRITE_SPANS, SPRITE_PIXELS, SPRITE_INDICES };\n", name, width, height);
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+// decodes the binary telemetry stream of the renderer (see `Telemetry.h`)
+//
+// usage: telemetry [stream.bin]
+//
+// the stream is read from the given file, or from the standard input
+// (e.g. a capture of the serial port of the console), and we report:
+//   - for each slice, the mean time spent in each observer, in sending
+//     the slice to the DMA controller and in waiting for the transfers
+//   - the timeline of the last complete frame
+//   - the histogram of the waiting times
+
+#include <stdio.h>
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include "Telemetry.h"
+
+struct Stat
+{
+    uint64_t total;
+    uint32_t count;
+    uint16_t max;
+};
+
+static void kindName(uint8_t kind, char* name, size_t size) {
+    if (kind == TELEMETRY_SEND) {
+        snprintf(name, size, "send");
+    } else if (kind == TELEMETRY_WAIT) {
+        snprintf(name, size, "wait");
+    } else {
+        snprintf(name, size, "draw #%u", kind);
+    }
+}
+
+int main(int argc, char** argv) {
+    FILE* input = argc > 1 ? fopen(argv[1], "rb") : stdin;
+    if (input == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    std::vector<TelemetryRecord> records;
+    uint32_t dropped = 0;
+    uint32_t chunks = 0;
+
+    // the stream is scanned for the headers of the chunks,
+    // so that any other data sent over the serial port is skipped
+    int c, previous = EOF;
+    while ((c = fgetc(input)) != EOF) {
+        if (previous == 'T' && c == 'L') {
+            int count = fgetc(input);
+            int lost = fgetc(input);
+            if (count == EOF || lost == EOF) break;
+            for (int i = 0; i < count; i++) {
+                TelemetryRecord record;
+                if (fread(&record, sizeof(record), 1, input) != 1) break;
+                records.push_back(record);
+            }
+            dropped += lost;
+            chunks++;
+            previous = EOF;
+            continue;
+        }
+        previous = c;
+    }
+    if (input != stdin) fclose(input);
+
+    if (records.empty()) {
+        fprintf(stderr, "no telemetry found in the stream\n");
+        return 1;
+    }
+
+    // the statistics are gathered by slice and by kind of event
+    std::map<uint8_t, std::map<uint8_t, Stat>> slices;
+    std::vector<uint8_t> kinds;
+    std::vector<uint32_t> histogram(17, 0);
+    uint32_t frames = 1;
+
+    for (size_t i = 0; i < records.size(); i++) {
+        const TelemetryRecord& record = records[i];
+        if (i > 0 && record.frame != records[i - 1].frame) frames++;
+
+        Stat& stat = slices[record.slice][record.kind];
+        stat.total += record.duration;
+        stat.count++;
+        stat.max = std::max(stat.max, record.duration);
+        if (std::find(kinds.begin(), kinds.end(), record.kind) == kinds.end()) kinds.push_back(record.kind);
+
+        if (record.kind == TELEMETRY_WAIT) {
+            // buckets: 0, 1, 2-3, 4-7, 8-15... microseconds
+            uint8_t bucket = 0;
+            for (uint16_t d = record.duration; d; d >>= 1) bucket++;
+            histogram[bucket]++;
+        }
+    }
+    std::sort(kinds.begin(), kinds.end());
+
+    printf("%zu events in %u chunks, %u frames, %u events dropped\n\n", records.size(), chunks, frames, dropped);
+
+    // the mean time of each kind of event, slice by slice
+    char name[16];
+    printf("mean (max) time per slice, in microseconds\n");
+    printf("%6s", "slice");
+    for (uint8_t kind : kinds) {
+        kindName(kind, name, sizeof(name));
+        printf(" %16s", name);
+    }
+    printf("\n");
+    for (auto& slice : slices) {
+        printf("%6u", slice.first);
+        for (uint8_t kind : kinds) {
+            auto it = slice.second.find(kind);
+            if (it == slice.second.end()) {
+                printf(" %16s", "-");
+            } else {
+                char cell[24];
+                snprintf(cell, sizeof(cell), "%llu (%u)", (unsigned long long)(it->second.total / it->second.count), it->second.max);
+                printf(" %16s", cell);
+            }
+        }
+        printf("\n");
+    }
+
+    // the timeline of the last complete frame (the last one may be truncated)
+    uint16_t last = records.back().frame;
+    uint16_t frame = last;
+    for (size_t i = records.size(); i-- > 0;) {
+        if (records[i].frame != last) {
+            frame = records[i].frame;
+            break;
+        }
+    }
+    printf("\ntimeline of the frame %u\n", frame);
+    printf("%8s %8s %6s  %s\n", "start", "duration", "slice", "event");
+    for (const TelemetryRecord& record : records) {
+        if (record.frame != frame) continue;
+        kindName(record.kind, name, sizeof(name));
+        printf("%8u %8u %6u  %s\n", record.start, record.duration, record.slice, name);
+    }
+
+    // the distribution of the waiting times
+    printf("\nhistogram of the waiting times\n");
+    uint32_t peak = *std::max_element(histogram.begin(), histogram.end());
+    for (uint8_t bucket = 0; bucket < histogram.size(); bucket++) {
+        if (histogram[bucket] == 0) continue;
+        uint32_t from = bucket ? 1 << (bucket - 1) : 0;
+        uint32_t to = bucket ? (1 << bucket) - 1 : 0;
+        printf("%6u-%-6u %8u ", from, to, histogram[bucket]);
+        for (uint32_t i = 0; i < histogram[bucket] * 50 / peak; i++) putchar('#');
+        printf("\n");
+    }
+
+    return 0;
+}